@@ -0,0 +1,469 @@
+// Microbenchmarks of the phases of one PSO iteration, with a saved baseline
+// to detect performance regressions.
+//
+//   ./bench                          run and print the results
+//   ./bench --save baseline.json     also write them to a baseline file
+//   ./bench --compare baseline.json  compare with a baseline, exit status 1
+//                                    on a significant regression
+//
+// Options: --repetitions N (default 21), --min-time SECONDS per repetition
+// (default 0.01), --threshold FRACTION of slowdown that counts as a
+// regression (default 0.15), --cpu N to pin the benchmark to a processor.
+//
+// Every benchmark is timed over repetitions of a block of operations, the
+// block being sized once so it lasts at least min-time. The result is the
+// median time per operation over the repetitions, with the median absolute
+// deviation (MAD) as its spread. A benchmark regresses if its median grew
+// by more than the threshold and by more than three combined standard
+// deviations estimated from the MADs. The MAD only captures the noise
+// within a run; on machines with frequency scaling or other load, runs
+// differ by several percent, so pin with --cpu and keep the threshold
+// above that.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "rng.h"
+
+#include "pso_manager.h"
+#include "pso_particle.h"
+#include "pso_thread.h"
+#include "pso_timer.h"
+
+using namespace ParticleSwarmOptimization;
+
+namespace {
+
+	// Exposes the phases of an iteration. Evaluations return precomputed
+	// fitnesses, so only the optimizer's own work is measured.
+	class BenchManager : public Manager {
+	public:
+		BenchManager (const size_t numDimensions, const size_t numParticles)
+		: Manager(1, numDimensions, numParticles, static_cast<size_t>(-1)), mPool(0) {
+			RandomNumberGenerator rng(2);
+			mFitnessPool.resize( 64 );
+			for (size_t k = 0; k < mFitnessPool.size(); k++) {
+				for (size_t i = 0; i < numParticles; i++) {
+					mFitnessPool[k].push_back( rng.uniform(0, 1) );
+				}
+			}
+
+			// Evaluate once so that every particle has a best
+			iterate();
+			for (ParticleId pid = 0; pid < Manager::numParticles(); pid++) {
+				mInitialStates.push_back( particle(pid).current() );
+			}
+		}
+
+		// Returns the particles to their positions after the first iteration,
+		// with new random velocities
+		void renew () {
+			for (ParticleId pid = 0; pid < numParticles(); pid++) {
+				restoreParticle( pid, mInitialStates[pid].position, mInitialStates[pid].fitness );
+			}
+		}
+
+		void moveAll () {
+			for (ParticleId pid = 0; pid < numParticles(); pid++) {
+				moveParticle(pid);
+			}
+		}
+
+		// The ring topology does its work when the particles ask for their
+		// social best
+		size_t updateAndQueryTopology () {
+			updateTopology();
+			size_t sum = 0;
+			for (ParticleId pid = 0; pid < numParticles(); pid++) {
+				sum += socialBestId( particle(pid) );
+			}
+			return sum;
+		}
+
+		size_t gatherPositions () {
+			return evaluateCurrentPositions().size();
+		}
+
+		void trackBests () {
+			assignFitnesses( 0, nextFitnesses() );
+			updateBestSoFar();
+		}
+
+		double drawUniforms (const size_t count) {
+			double sum = 0;
+			for (size_t i = 0; i < count; i++) {
+				sum += uniform(0, 1);
+			}
+			return sum;
+		}
+
+		void step () {
+			iterate();
+		}
+
+	protected:
+		virtual Fitnesses evaluateFunction (const Positions& positions ) {
+			const Fitnesses& fitnesses = nextFitnesses();
+			return Fitnesses( fitnesses.begin(), fitnesses.begin() + std::min(positions.size(), fitnesses.size()) );
+		}
+
+	private:
+		const Fitnesses& nextFitnesses () {
+			mPool = (mPool + 1) % mFitnessPool.size();
+			return mFitnessPool[mPool];
+		}
+
+		std::vector<Fitnesses> mFitnessPool;
+		size_t mPool;
+
+		std::vector<Particle::State> mInitialStates;
+	};
+
+	// Keeps results alive so the compiler cannot drop the work
+	volatile double gSink = 0;
+
+	enum Phase {
+		UpdateKernel,
+		Topology,
+		Gather,
+		BestTracking,
+		Rng,
+		Iteration
+	};
+
+	const size_t UNIFORMS_PER_OPERATION = 1000;
+
+	struct Benchmark {
+		std::string name;
+		Phase phase;
+		size_t numDimensions;
+		size_t numParticles;
+	};
+
+	struct Result {
+		std::string name;
+		double medianNs;
+		double madNs;
+		size_t repetitions;
+		size_t operations;
+	};
+
+	void runOperation (BenchManager& manager, const Phase phase) {
+		switch (phase) {
+			case UpdateKernel:
+				manager.moveAll();
+				break;
+			case Topology:
+				gSink = gSink + manager.updateAndQueryTopology();
+				break;
+			case Gather:
+				gSink = gSink + manager.gatherPositions();
+				break;
+			case BestTracking:
+				manager.trackBests();
+				break;
+			case Rng:
+				gSink = gSink + manager.drawUniforms(UNIFORMS_PER_OPERATION);
+				break;
+			case Iteration:
+				manager.step();
+				break;
+		}
+	}
+
+	// Operations timed from one fresh swarm. A converging swarm slows down
+	// as its coordinates become subnormal, so the measured state is reset
+	// after this many operations, outside of the timing.
+	const size_t OPERATIONS_PER_SWARM = 32;
+
+	double timeBlock (BenchManager& manager, const Phase phase, const size_t operations) {
+		double seconds = 0;
+		for (size_t done = 0; done < operations; done += OPERATIONS_PER_SWARM) {
+			manager.renew();
+
+			const size_t count = std::min(OPERATIONS_PER_SWARM, operations - done);
+			const double start = monotonicSeconds();
+			for (size_t i = 0; i < count; i++) {
+				runOperation(manager, phase);
+			}
+			seconds += monotonicSeconds() - start;
+		}
+		return seconds;
+	}
+
+	double median (std::vector<double> values) {
+		std::sort( values.begin(), values.end() );
+		const size_t n = values.size();
+		return (n % 2 == 1 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]));
+	}
+
+	Result summarize (const Benchmark& benchmark, std::vector<double> samples, const size_t operations) {
+		Result result;
+		result.name = benchmark.name;
+		result.medianNs = median( samples );
+		for (size_t r = 0; r < samples.size(); r++) {
+			samples[r] = std::fabs( samples[r] - result.medianNs );
+		}
+		result.madNs = median( samples );
+		result.repetitions = samples.size();
+		result.operations = operations;
+		return result;
+	}
+
+	// The repetitions of all benchmarks are interleaved, so that a drift of
+	// the machine's speed during the run affects them all alike
+	std::vector<Result> runAll (const std::vector<Benchmark>& list, const size_t repetitions, const double minTime) {
+		std::vector<BenchManager*> managers;
+		std::vector<size_t> operations;
+		std::vector< std::vector<double> > samples( list.size() );
+
+		try {
+			for (size_t b = 0; b < list.size(); b++) {
+				managers.push_back( new BenchManager(list[b].numDimensions, list[b].numParticles) );
+
+				// Size the block, which doubles as warm-up
+				size_t count = 1;
+				while (timeBlock(*managers[b], list[b].phase, count) < minTime) {
+					count *= 2;
+				}
+				operations.push_back( count );
+			}
+
+			for (size_t r = 0; r < repetitions; r++) {
+				for (size_t b = 0; b < list.size(); b++) {
+					samples[b].push_back( 1e9 * timeBlock(*managers[b], list[b].phase, operations[b]) / operations[b] );
+				}
+			}
+		} catch (...) {
+			for (size_t b = 0; b < managers.size(); b++) {
+				delete managers[b];
+			}
+			throw;
+		}
+
+		std::vector<Result> results;
+		for (size_t b = 0; b < list.size(); b++) {
+			results.push_back( summarize(list[b], samples[b], operations[b]) );
+			delete managers[b];
+		}
+		return results;
+	}
+
+	std::vector<Benchmark> benchmarks () {
+		static const char* const PHASES[] = { "update_kernel", "topology", "gather_positions", "best_tracking", "rng_uniform_x1000", "iteration" };
+		static const size_t SIZES[][2] = { {10, 20}, {50, 1000} };
+
+		std::vector<Benchmark> list;
+		for (size_t s = 0; s < 2; s++) {
+			for (size_t p = 0; p < 6; p++) {
+				// The RNG does not depend on the swarm size
+				if ( (p == Rng) && (s != 0) ) {
+					continue;
+				}
+
+				std::ostringstream name;
+				name << PHASES[p];
+				if (p != Rng) {
+					name << "/" << SIZES[s][1] << "x" << SIZES[s][0];
+				}
+
+				Benchmark b;
+				b.name = name.str();
+				b.phase = static_cast<Phase>(p);
+				b.numDimensions = SIZES[s][0];
+				b.numParticles = SIZES[s][1];
+				list.push_back( b );
+			}
+		}
+		return list;
+	}
+
+	void save (const std::string& path, const std::vector<Result>& results) {
+		std::ofstream out( path.c_str() );
+		if (!out) {
+			throw std::runtime_error("Unable to write " + path);
+		}
+
+		out.precision(6);
+		out << "{\n";
+		out << "  \"version\": 1,\n";
+		out << "  \"component_size\": " << sizeof(VecCom) << ",\n";
+		out << "  \"benchmarks\": [\n";
+		for (size_t i = 0; i < results.size(); i++) {
+			const Result& r = results[i];
+			out << "    {\"name\": \"" << r.name << "\", \"median_ns\": " << r.medianNs << ", \"mad_ns\": " << r.madNs
+				<< ", \"repetitions\": " << r.repetitions << ", \"operations\": " << r.operations << "}"
+				<< (i + 1 < results.size() ? "," : "") << "\n";
+		}
+		out << "  ]\n";
+		out << "}\n";
+	}
+
+	// Value of a numeric field in one line of a baseline file
+	bool readNumber (const std::string& line, const std::string& field, double& value) {
+		const std::string key = "\"" + field + "\":";
+		const size_t at = line.find(key);
+		if (at == std::string::npos) {
+			return false;
+		}
+		value = std::strtod( line.c_str() + at + key.size(), 0 );
+		return true;
+	}
+
+	// Reads a file written by save(), one benchmark per line
+	std::vector<Result> load (const std::string& path) {
+		std::ifstream in( path.c_str() );
+		if (!in) {
+			throw std::runtime_error("Unable to read " + path);
+		}
+
+		std::vector<Result> results;
+		std::string line;
+		while (std::getline(in, line)) {
+			const std::string key = "\"name\": \"";
+			const size_t at = line.find(key);
+			if (at == std::string::npos) {
+				continue;
+			}
+			const size_t end = line.find('"', at + key.size());
+
+			Result r;
+			r.name = line.substr(at + key.size(), end - at - key.size());
+			double repetitions = 0;
+			double operations = 0;
+			if ( (end == std::string::npos) || !readNumber(line, "median_ns", r.medianNs) || !readNumber(line, "mad_ns", r.madNs) ) {
+				throw std::runtime_error("Malformed baseline " + path);
+			}
+			readNumber(line, "repetitions", repetitions);
+			readNumber(line, "operations", operations);
+			r.repetitions = static_cast<size_t>(repetitions);
+			r.operations = static_cast<size_t>(operations);
+			results.push_back( r );
+		}
+		return results;
+	}
+
+	// Returns the number of regressions
+	size_t compare (const std::vector<Result>& baseline, const std::vector<Result>& results, const double threshold) {
+		// Scales a MAD to a standard deviation for normal data
+		const double MAD_TO_SIGMA = 1.4826;
+
+		size_t regressions = 0;
+		std::printf("%-32s %12s %12s %8s  %s\n", "benchmark", "baseline ns", "current ns", "change", "verdict");
+		for (size_t i = 0; i < results.size(); i++) {
+			const Result& r = results[i];
+
+			const Result* base = 0;
+			for (size_t j = 0; j < baseline.size(); j++) {
+				if (baseline[j].name == r.name) {
+					base = &baseline[j];
+				}
+			}
+			if (base == 0) {
+				std::printf("%-32s %12s %12.1f %8s  new\n", r.name.c_str(), "-", r.medianNs, "-");
+				continue;
+			}
+
+			const double difference = r.medianNs - base->medianNs;
+			const double noise = 3 * MAD_TO_SIGMA * std::sqrt( r.madNs * r.madNs + base->madNs * base->madNs );
+			const double change = (base->medianNs > 0 ? difference / base->medianNs : 0.0);
+
+			const char* verdict = "ok";
+			if ( (change > threshold) && (difference > noise) ) {
+				verdict = "REGRESSION";
+				regressions++;
+			} else if ( (change < -threshold) && (-difference > noise) ) {
+				verdict = "improved";
+			}
+			std::printf("%-32s %12.1f %12.1f %+7.1f%%  %s\n", r.name.c_str(), base->medianNs, r.medianNs, 100 * change, verdict);
+		}
+		return regressions;
+	}
+
+	void usage () {
+		std::cerr << "usage: bench [--save FILE] [--compare FILE] [--repetitions N] [--min-time SECONDS]"
+			" [--threshold FRACTION] [--cpu N]" << std::endl;
+	}
+
+}; // namespace
+
+int main (int argc, char** argv) {
+	std::string savePath;
+	std::string comparePath;
+	size_t repetitions = 21;
+	double minTime = 0.01;
+	double threshold = 0.15;
+	int cpu = -1;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (i + 1 >= argc) {
+			usage();
+			return 2;
+		}
+		const char* value = argv[++i];
+		if (arg == "--save") {
+			savePath = value;
+		} else if (arg == "--compare") {
+			comparePath = value;
+		} else if (arg == "--repetitions") {
+			repetitions = std::max(1, std::atoi(value));
+		} else if (arg == "--min-time") {
+			minTime = std::atof(value);
+		} else if (arg == "--threshold") {
+			threshold = std::atof(value);
+		} else if (arg == "--cpu") {
+			cpu = std::atoi(value);
+		} else {
+			usage();
+			return 2;
+		}
+	}
+
+	if ( (cpu >= 0) && !pinCurrentThread(cpu) ) {
+		std::cerr << "warning: unable to pin to processor " << cpu << std::endl;
+	}
+
+	try {
+		std::vector<Result> baseline;
+		if (!comparePath.empty()) {
+			// Fail early on a bad baseline
+			baseline = load( comparePath );
+		}
+
+		const std::vector<Result> results = runAll( benchmarks(), repetitions, minTime );
+		if (comparePath.empty()) {
+			for (size_t i = 0; i < results.size(); i++) {
+				const Result& r = results[i];
+				std::printf("%-32s %12.1f ns  +- %8.1f (MAD, %lu x %lu ops)\n", r.name.c_str(), r.medianNs, r.madNs,
+					static_cast<unsigned long>(r.repetitions), static_cast<unsigned long>(r.operations));
+			}
+		}
+
+		if (!savePath.empty()) {
+			save( savePath, results );
+		}
+
+		if (!comparePath.empty()) {
+			const size_t regressions = compare( baseline, results, threshold );
+			if (regressions != 0) {
+				std::printf("%lu significant regression(s)\n", static_cast<unsigned long>(regressions));
+				return 1;
+			}
+		}
+	} catch (const std::exception& e) {
+		std::cerr << "error: " << e.what() << std::endl;
+		return 2;
+	}
+
+	return 0;
+}
@@ -1,8 +1,10 @@
 #include <iostream>
 #include <stdexcept>
 #include <cstdlib>
+#include <limits>
 
 #include "pso.h"
+#include "pso_statistics.h"
 
 #include <gsl/gsl_math.h>
 #include <gsl/gsl_sf.h>
@@ -16,6 +18,8 @@ const double RANGE = 4.0;
 const double TRUE_X = 2.9;
 const double TRUE_Y = -0.25;
 
+const double TARGET_FITNESS = 1e-3;
+
 // Converts from pso coordinates to function coordinates
 // Specifically: PSO's [-1, 1] to  Func's [min, max]
 double convertPSOCoord(const double min, const double max, const double pso_coord) {
@@ -163,16 +167,36 @@ private:
     std::vector<IterationResult> mIterationResult;
 };
 
+// Summary of all trials. Per-iteration histories are only kept if the
+// analysis records them, everything else is aggregated in constant memory.
 class PSOResult {
 public:
+    PSOResult()
+    : mBestFitness(std::numeric_limits<ParticleSwarmOptimization::Fitness>::max())
+    {
+
+    }
+
     void clear() {
         mTrialResult.clear();
+        mStatistics = ParticleSwarmOptimization::TrialStatistics();
+        mBestEstimate.clear();
+        mBestFitness = std::numeric_limits<ParticleSwarmOptimization::Fitness>::max();
     }
 
     void add (const TrialResult& trialResult ) {
         mTrialResult.push_back (trialResult);
     }
 
+    void addTrialSummary (const ParticleSwarmOptimization::Position& estimate, const ParticleSwarmOptimization::Fitness fitness,
+        const bool reachedTarget, const size_t evaluationsToTarget) {
+        mStatistics.add(fitness, reachedTarget, evaluationsToTarget);
+        if (fitness < mBestFitness) {
+            mBestFitness = fitness;
+            mBestEstimate = estimate;
+        }
+    }
+
     const TrialResult& getTrialResult (const int index) const {
         return mTrialResult.at (index);
     }
@@ -181,25 +205,26 @@ public:
         return mTrialResult.size();
     }
 
+    const ParticleSwarmOptimization::TrialStatistics& getStatistics() const {
+        return mStatistics;
+    }
+
     double getFitness() const {
-        const TrialResult& bestTrial = getBestTrial();
-        const IterationResult& bestIteration = bestTrial.getBestResult();
-        return bestIteration.getFitness();
+        return mBestFitness;
     }
 
     const ParticleSwarmOptimization::Position& getEstimate() const {
-        const TrialResult& bestTrial = getBestTrial();
-        const IterationResult& bestIteration = bestTrial.getBestResult();
-        return bestIteration.getPosition();
+        return mBestEstimate;
     }
 
+    // Only available if histories were recorded
     const TrialResult& getBestTrial() const {
         int bestIndex = 0;
         ParticleSwarmOptimization::Fitness bestFitness = getTrialResult(0).getBestResult().getFitness();
 
         for (int i = 1; i < mTrialResult.size(); i++) {
             ParticleSwarmOptimization::Fitness f = getTrialResult(i).getBestResult().getFitness();
-            if (f > bestFitness) {
+            if (f < bestFitness) {
                 bestIndex = i;
                 bestFitness = f;
             }
@@ -210,6 +235,9 @@ public:
 
 private:
     std::vector<TrialResult> mTrialResult;
+    ParticleSwarmOptimization::TrialStatistics mStatistics;
+    ParticleSwarmOptimization::Position mBestEstimate;
+    ParticleSwarmOptimization::Fitness mBestFitness;
 };
 
 
@@ -219,13 +247,19 @@ template<typename FitnessFunction>
 class PSOAnalysis : private ParticleSwarmOptimization::Manager {
 public:
 	PSOAnalysis(FitnessFunction& ff, const gslseed_t seed, const size_t numPSOTrials, const size_t numDimensions, const size_t numParticles, const size_t numIterations,
-    const ParticleSwarmOptimization::Weight inertiaStart, const ParticleSwarmOptimization::Weight inertiaEnd, const ParticleSwarmOptimization::Weight cognitive, const ParticleSwarmOptimization::Weight social )
+    const ParticleSwarmOptimization::Weight inertiaStart, const ParticleSwarmOptimization::Weight inertiaEnd, const ParticleSwarmOptimization::Weight cognitive, const ParticleSwarmOptimization::Weight social,
+    const bool recordHistory = false )
 	: ParticleSwarmOptimization::Manager(seed, numDimensions, numParticles, numIterations,
         inertiaStart, inertiaEnd, cognitive, social), 
-      mFitnessFunction(ff), mNumPSOTrials(numPSOTrials) {
+      mFitnessFunction(ff), mNumPSOTrials(numPSOTrials), mRecordHistory(recordHistory) {
         mCurrentPSOTrial = 0;
 	}
 
+    // Counts a trial as successful once its fitness reaches the target
+    void setTargetFitness(const ParticleSwarmOptimization::Fitness target) {
+        ParticleSwarmOptimization::Manager::setTargetFitness(target);
+    }
+
 	PSOResult& perform() {
         mPSOResult.clear();
 
@@ -267,17 +301,22 @@ protected:
 	virtual void iterate () {
 		ParticleSwarmOptimization::Manager::iterate();
 
-		// Get the best estimate for this iteration step
-		ParticleSwarmOptimization::Position estimate = this->getEstimate();
+        if (mRecordHistory) {
+            // Get the best estimate for this iteration step
+            ParticleSwarmOptimization::Position estimate = this->getEstimate();
 
-        // Get the fitness for the best estimate
-        ParticleSwarmOptimization::Fitness fitness = this->getFitness();
+            // Get the fitness for the best estimate
+            ParticleSwarmOptimization::Fitness fitness = this->getFitness();
 
-        recordIterationEstimate(estimate, fitness);
+            recordIterationEstimate(estimate, fitness);
+        }
 	}
 
     void recordTrialEstimate(const ParticleSwarmOptimization::Position& estimate, const ParticleSwarmOptimization::Fitness& fitness) {
-        mPSOResult.add (mCurrentTrialResult);
+        if (mRecordHistory) {
+            mPSOResult.add (mCurrentTrialResult);
+        }
+        mPSOResult.addTrialSummary(estimate, fitness, this->hasReachedTarget(), this->evaluationsToTarget());
         std::cout << "(" << estimate[0] << ", " << estimate[1] << ") = " << fitness << std::endl;
     }
 
@@ -300,6 +339,7 @@ private:
 	FitnessFunction mFitnessFunction;
     size_t          mNumPSOTrials;
     size_t          mCurrentPSOTrial;
+    bool            mRecordHistory;
 
     PSOResult       mPSOResult;
     TrialResult     mCurrentTrialResult;
@@ -319,8 +359,15 @@ int main(int argc, char* argv[]) {
 		PSOAnalysis<AckleyFunction> pso(ff, seed, NUM_TRIALS, NUM_DIMENSIONS, NUM_PARTICLES, arg_numIterations,
             0.9, 0.9, 0.2, 0.2);
 
-		pso.perform();
+        pso.setTargetFitness(TARGET_FITNESS);
+
+		const PSOResult& result = pso.perform();
 		std::cout << "true: " << TRUE_X << " " << TRUE_Y << "\n";
+
+        const ParticleSwarmOptimization::TrialStatistics& stats = result.getStatistics();
+        std::cout << "best: " << stats.bestFitness() << " mean: " << stats.meanFitness()
+            << " median: " << stats.medianFitness() << " success rate: " << stats.successRate()
+            << " mean evaluations to target: " << stats.meanEvaluationsToTarget() << "\n";
 	} catch(const std::exception& e) {
 		std::cerr << "ERROR: " << e.what() << std::endl;
 		return -1;
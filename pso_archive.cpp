@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include "rng.h"
+
+#include "pso_archive.h"
+
+#include "pso_manager.h"
+
+#include "pso_particle.h"
+
+namespace ParticleSwarmOptimization {
+
+	static const char MAGIC[8] = {'P', 'S', 'O', 'A', 'R', 'C', 'H', 'V'};
+	static const unsigned long long VERSION = 1;
+
+	static double euclideanDistance (const Position& a, const Position& b) {
+		double sum = 0;
+		for (size_t d = 0; d < a.size(); d++) {
+			const double diff = a[d] - b[d];
+			sum += diff * diff;
+		}
+		return std::sqrt(sum);
+	}
+
+	class EntryFitnessCmp {
+	public:
+		bool operator()(const SolutionArchive::Entry& a, const SolutionArchive::Entry& b) const {
+			return a.fitness < b.fitness;
+		}
+	};
+
+	// Orders entry indices by their distance to a vantage point
+	class VantageDistanceCmp {
+	public:
+		VantageDistanceCmp (const std::vector<SolutionArchive::Entry>& entries, const Position& vantage)
+		: mEntries(entries), mVantage(vantage) {}
+
+		bool operator()(const size_t a, const size_t b) const {
+			return euclideanDistance(mEntries[a].position, mVantage) < euclideanDistance(mEntries[b].position, mVantage);
+		}
+
+	private:
+		const std::vector<SolutionArchive::Entry>& mEntries;
+		const Position& mVantage;
+	};
+
+	SolutionArchive::SolutionArchive (const size_t numDimensions, const size_t capacity, const double minDistance)
+	: mNumDimensions(numDimensions), mCapacity(capacity), mMinDistance(minDistance), mIsTreeValid(false) {
+	}
+
+	bool SolutionArchive::add (const Position& position, const Fitness fitness) {
+		if (position.size() != mNumDimensions) {
+			throw std::invalid_argument("SolutionArchive: wrong number of dimensions");
+		}
+		if ( isFailedFitness(fitness) || (fitness == WorstPossibleFitness()) || (mCapacity == 0) ) {
+			return false;
+		}
+
+		if ( (mMinDistance > 0) && !mEntries.empty() ) {
+			const size_t near = nearest(position, 1).front();
+			if (euclideanDistance(mEntries[near].position, position) < mMinDistance) {
+				if (fitness >= mEntries[near].fitness) {
+					return false;
+				}
+				mEntries[near].position = position;
+				mEntries[near].fitness = fitness;
+				sortByFitness();
+				return true;
+			}
+		}
+
+		if (mEntries.size() == mCapacity) {
+			if (fitness >= mEntries.back().fitness) {
+				return false;
+			}
+			mEntries.pop_back();
+		}
+
+		Entry entry;
+		entry.position = position;
+		entry.fitness = fitness;
+		mEntries.push_back(entry);
+		sortByFitness();
+		return true;
+	}
+
+	void SolutionArchive::addElites (const Manager& manager, const size_t count) {
+		std::vector< std::pair<Fitness, ParticleId> > ranked;
+		for (ParticleId pid = 0; pid < manager.numParticles(); pid++) {
+			ranked.push_back( std::make_pair(manager.particle(pid).best().fitness, pid) );
+		}
+
+		const size_t n = std::min(count, ranked.size());
+		std::partial_sort( ranked.begin(), ranked.begin() + n, ranked.end() );
+		for (size_t i = 0; i < n; i++) {
+			const Particle::State& best = manager.particle( ranked[i].second ).best();
+			add( best.position, best.fitness );
+		}
+	}
+
+	void SolutionArchive::sortByFitness () {
+		std::stable_sort( mEntries.begin(), mEntries.end(), EntryFitnessCmp() );
+		mIsTreeValid = false;
+	}
+
+	void SolutionArchive::load (const std::string& path) {
+		std::ifstream in( path.c_str(), std::ios::binary );
+		if (!in) {
+			throw std::runtime_error("SolutionArchive: cannot open " + path);
+		}
+
+		char magic[8];
+		unsigned long long header[4];
+		in.read( magic, sizeof(magic) );
+		in.read( reinterpret_cast<char*>(header), sizeof(header) );
+		if ( !in || (std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) || (header[0] != VERSION) ) {
+			throw std::runtime_error("SolutionArchive: not an archive file " + path);
+		}
+		if ( (header[1] != sizeof(VecCom)) || (header[2] != mNumDimensions) ) {
+			throw std::runtime_error("SolutionArchive: archive of another precision or number of dimensions " + path);
+		}
+
+		// The entry count comes from the file; check it against the bytes left before allocating
+		const std::streampos start = in.tellg();
+		in.seekg( 0, std::ios::end );
+		const unsigned long long remaining = static_cast<unsigned long long>( in.tellg() - start );
+		in.seekg( start );
+		const unsigned long long entrySize = sizeof(Fitness) + mNumDimensions * sizeof(VecCom);
+		if ( !in || (header[3] > remaining / entrySize) ) {
+			throw std::runtime_error("SolutionArchive: truncated archive " + path);
+		}
+
+		std::vector<Entry> entries( static_cast<size_t>(header[3]) );
+		for (size_t i = 0; i < entries.size(); i++) {
+			entries[i].position.resize( mNumDimensions );
+			in.read( reinterpret_cast<char*>(&entries[i].fitness), sizeof(Fitness) );
+			in.read( reinterpret_cast<char*>(&entries[i].position[0]), mNumDimensions * sizeof(VecCom) );
+		}
+		if (!in) {
+			throw std::runtime_error("SolutionArchive: truncated archive " + path);
+		}
+
+		mEntries.clear();
+		for (size_t i = 0; i < entries.size(); i++) {
+			add( entries[i].position, entries[i].fitness );
+		}
+	}
+
+	void SolutionArchive::save (const std::string& path) const {
+		std::ofstream out( path.c_str(), std::ios::binary | std::ios::trunc );
+
+		const unsigned long long header[4] = { VERSION, sizeof(VecCom), mNumDimensions, mEntries.size() };
+		out.write( MAGIC, sizeof(MAGIC) );
+		out.write( reinterpret_cast<const char*>(header), sizeof(header) );
+		for (size_t i = 0; i < mEntries.size(); i++) {
+			out.write( reinterpret_cast<const char*>(&mEntries[i].fitness), sizeof(Fitness) );
+			out.write( reinterpret_cast<const char*>(&mEntries[i].position[0]), mNumDimensions * sizeof(VecCom) );
+		}
+
+		out.close();
+		if (!out) {
+			throw std::runtime_error("SolutionArchive: cannot write " + path);
+		}
+	}
+
+	size_t SolutionArchive::numDimensions () const {
+		return mNumDimensions;
+	}
+
+	size_t SolutionArchive::capacity () const {
+		return mCapacity;
+	}
+
+	size_t SolutionArchive::size () const {
+		return mEntries.size();
+	}
+
+	bool SolutionArchive::empty () const {
+		return mEntries.empty();
+	}
+
+	const SolutionArchive::Entry& SolutionArchive::entry (const size_t i) const {
+		return mEntries.at(i);
+	}
+
+	std::vector<size_t> SolutionArchive::nearest (const Position& position, const size_t k) const {
+		if (!mIsTreeValid) {
+			std::vector<size_t> entries( mEntries.size() );
+			for (size_t i = 0; i < entries.size(); i++) {
+				entries[i] = i;
+			}
+			mTree.clear();
+			mTree.reserve( entries.size() );
+			buildTree( entries, 0, entries.size() );
+			mIsTreeValid = true;
+		}
+
+		std::vector<Neighbour> heap;
+		if ( (k > 0) && !mTree.empty() ) {
+			searchTree( 0, position, k, heap );
+		}
+		std::sort_heap( heap.begin(), heap.end() );
+
+		std::vector<size_t> indices;
+		for (size_t i = 0; i < heap.size(); i++) {
+			indices.push_back( heap[i].second );
+		}
+		return indices;
+	}
+
+	// The vantage point's children hold the entries inside its radius and
+	// the entries outside of it, split at the median distance
+	int SolutionArchive::buildTree (std::vector<size_t>& entries, const size_t first, const size_t last) const {
+		if (first >= last) {
+			return -1;
+		}
+
+		const int node = static_cast<int>( mTree.size() );
+		Node vantage;
+		vantage.entry = entries[first];
+		vantage.radius = 0;
+		vantage.inside = -1;
+		vantage.outside = -1;
+		mTree.push_back( vantage );
+
+		if (last - first > 1) {
+			const size_t median = (first + 1 + last) / 2;
+			const Position& center = mEntries[ vantage.entry ].position;
+			std::nth_element( entries.begin() + first + 1, entries.begin() + median, entries.begin() + last,
+				VantageDistanceCmp(mEntries, center) );
+			mTree[node].radius = euclideanDistance( mEntries[ entries[median] ].position, center );
+
+			const int inside = buildTree( entries, first + 1, median );
+			const int outside = buildTree( entries, median, last );
+			mTree[node].inside = inside;
+			mTree[node].outside = outside;
+		}
+		return node;
+	}
+
+	void SolutionArchive::searchTree (const int node, const Position& position, const size_t k, std::vector<Neighbour>& heap) const {
+		if (node < 0) {
+			return;
+		}
+
+		const Node& vantage = mTree[node];
+		const double d = euclideanDistance( mEntries[ vantage.entry ].position, position );
+		if (heap.size() < k) {
+			heap.push_back( Neighbour(d, vantage.entry) );
+			std::push_heap( heap.begin(), heap.end() );
+		} else if (d < heap.front().first) {
+			std::pop_heap( heap.begin(), heap.end() );
+			heap.back() = Neighbour(d, vantage.entry);
+			std::push_heap( heap.begin(), heap.end() );
+		}
+
+		// Visit the more promising side first, the other only if it can
+		// still hold a nearer entry
+		const bool isInside = (d < vantage.radius);
+		const int nearSide = (isInside ? vantage.inside : vantage.outside);
+		const int farSide = (isInside ? vantage.outside : vantage.inside);
+		searchTree( nearSide, position, k, heap );
+
+		const double tau = ( heap.size() < k ? std::numeric_limits<double>::max() : heap.front().first );
+		if ( (isInside && (d + tau >= vantage.radius)) || (!isInside && (d - tau <= vantage.radius)) ) {
+			searchTree( farSide, position, k, heap );
+		}
+	}
+
+	ArchiveInitializer::ArchiveInitializer (const SolutionArchive& archive, const double eliteFraction,
+	 const double perturbedFraction, const double perturbation)
+	: mArchive(archive), mEliteFraction(eliteFraction), mPerturbedFraction(perturbedFraction), mPerturbation(perturbation) {
+	}
+
+	void ArchiveInitializer::generate (const size_t numPoints, const size_t numDimensions,
+		RandomNumberGenerator& rng, Positions& points) {
+		if (numDimensions != mArchive.numDimensions()) {
+			throw std::invalid_argument("ArchiveInitializer: the archive has another number of dimensions");
+		}
+
+		size_t numElites = 0;
+		size_t numPerturbed = 0;
+		if (!mArchive.empty()) {
+			numElites = std::min( static_cast<size_t>(mEliteFraction * numPoints + 0.5), std::min(numPoints, mArchive.size()) );
+			numPerturbed = std::min( static_cast<size_t>(mPerturbedFraction * numPoints + 0.5), numPoints - numElites );
+		}
+
+		points.reserve( points.size() + numPoints );
+		for (size_t i = 0; i < numElites; i++) {
+			points.push_back( mArchive.entry(i).position );
+		}
+
+		// Cycle through the elites, best first
+		for (size_t i = 0; i < numPerturbed; i++) {
+			Position pos( mArchive.entry(i % mArchive.size()).position );
+			for (size_t d = 0; d < numDimensions; d++) {
+				const double x = pos[d] + rng.gaussian(mPerturbation);
+				pos[d] = static_cast<VecCom>( std::max(-1.0, std::min(1.0, x)) );
+			}
+			points.push_back( pos );
+		}
+
+		UniformInitializer uniform;
+		uniform.generate( numPoints - numElites - numPerturbed, numDimensions, rng, points );
+	}
+
+	bool ArchiveInitializer::isSeeded () const {
+		return true;
+	}
+
+}; // namespace
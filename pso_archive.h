@@ -0,0 +1,106 @@
+#ifndef INC_PSO_ARCHIVE_H
+#define INC_PSO_ARCHIVE_H
+
+#include <string>
+#include <vector>
+
+#include "pso_types.h"
+#include "pso_initializer.h"
+
+namespace ParticleSwarmOptimization {
+
+	class Manager;
+
+	// The best positions found by past runs, kept on disk between runs.
+	//
+	// At most capacity entries are kept, the best ones. A new entry closer
+	// than minDistance to an archived one replaces it only if it is better,
+	// so the archive holds distinct elites. Nearest-neighbour lookups use a
+	// vantage-point tree, which is rebuilt on the first lookup after a change.
+	//
+	// File layout, in the byte order of the writing machine:
+	//   char[8] "PSOARCHV", unsigned long long version (1),
+	//   unsigned long long sizeof(VecCom), unsigned long long numDimensions,
+	//   unsigned long long numEntries, then per entry: double fitness,
+	//   numDimensions VecCom.
+	class SolutionArchive {
+	public:
+		struct Entry {
+			Position position;
+			Fitness fitness;
+		};
+
+		SolutionArchive (const size_t numDimensions, const size_t capacity, const double minDistance = 0);
+
+		// Adds a solution, see the class description. Returns false if it
+		// was not kept.
+		bool add (const Position& position, const Fitness fitness);
+
+		// Adds the personal bests of the count best particles of a swarm
+		void addElites (const Manager& manager, const size_t count);
+
+		// Replaces the contents by the file's, or writes them to the file.
+		// Throw std::runtime_error on failure.
+		void load (const std::string& path);
+		void save (const std::string& path) const;
+
+		size_t numDimensions () const;
+		size_t capacity () const;
+		size_t size () const;
+		bool empty () const;
+
+		// Entries sorted by fitness, best first
+		const Entry& entry (const size_t i) const;
+
+		// Indices of the k entries nearest to the position, nearest first
+		std::vector<size_t> nearest (const Position& position, const size_t k) const;
+
+	private:
+		struct Node {
+			size_t entry;
+			double radius;
+			int inside;
+			int outside;
+		};
+
+		// Candidate during a k-nearest search, the farthest on top
+		typedef std::pair<double, size_t> Neighbour;
+
+		int buildTree (std::vector<size_t>& entries, const size_t first, const size_t last) const;
+		void searchTree (const int node, const Position& position, const size_t k, std::vector<Neighbour>& heap) const;
+		void sortByFitness ();
+
+		size_t mNumDimensions;
+		size_t mCapacity;
+		double mMinDistance;
+		std::vector<Entry> mEntries;
+
+		mutable std::vector<Node> mTree;
+		mutable bool mIsTreeValid;
+	};
+
+	// Seeds a swarm from a SolutionArchive: the best archived elites as they
+	// are, then copies of the elites perturbed by Gaussian noise of the given
+	// standard deviation, then uniformly random positions. The fractions are
+	// of the number of points requested. The archive is not owned and must
+	// have the swarm's number of dimensions.
+	class ArchiveInitializer : public Initializer {
+	public:
+		ArchiveInitializer (const SolutionArchive& archive, const double eliteFraction = 0.2,
+		 const double perturbedFraction = 0.5, const double perturbation = 0.05);
+
+		virtual void generate (const size_t numPoints, const size_t numDimensions,
+			RandomNumberGenerator& rng, Positions& points);
+
+		virtual bool isSeeded () const;
+
+	private:
+		const SolutionArchive& mArchive;
+		double mEliteFraction;
+		double mPerturbedFraction;
+		double mPerturbation;
+	};
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_ARCHIVE_H
@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "pso_binary.h"
+
+#include "pso_particle.h"
+
+namespace ParticleSwarmOptimization {
+
+	// The original binary PSO weights. Without inertia decay the velocities of
+	// settled bits stay saturated instead of drifting back to probability 0.5.
+	BinaryManager::BinaryManager (const gslseed_t seed, const size_t numBits, const size_t numParticles, const size_t numIterations)
+	: Manager(seed, 0, numParticles, numIterations, 1.0, 1.0, 2.0, 2.0), mNumBits(numBits), mBestBitsFitness(WorstPossibleFitness()) {
+		setMaxSpeedPerDimension(4.0);
+		createBitStates();
+	}
+
+	BinaryManager::BinaryManager (const gslseed_t seed, const size_t numBits, const size_t numParticles, const size_t numIterations,
+		 const Weight inertiaStart, const Weight inertiaEnd, const Weight cognitive, const Weight social)
+	: Manager(seed, 0, numParticles, numIterations, inertiaStart, inertiaEnd, cognitive, social),
+	  mNumBits(numBits), mBestBitsFitness(WorstPossibleFitness()) {
+		setMaxSpeedPerDimension(4.0);
+		createBitStates();
+	}
+
+	BinaryManager::~BinaryManager () {
+	}
+
+	void BinaryManager::createBitStates () {
+		const size_t np = numParticles();
+		const size_t numWords = numWordsFor(mNumBits);
+
+		mPositions.assign( np, BitString(numWords, 0) );
+		mVelocities.assign( np, Velocity(mNumBits) );
+		for (size_t i = 0; i < np; i++) {
+			for (size_t b = 0; b < mNumBits; b++) {
+				setBit( mPositions[i], b, uniform(0, 1) < 0.5 );
+				mVelocities[i][b] = static_cast<VecCom>( uniform() );
+			}
+		}
+
+		// Not evaluated yet, the particles' best fitnesses are the worst possible
+		mBests = mPositions;
+	}
+
+	void BinaryManager::reset () {
+		Manager::reset();
+
+		mBestBits.clear();
+		mBestBitsFitness = WorstPossibleFitness();
+		createBitStates();
+	}
+
+	void BinaryManager::restart (const size_t numParticles) {
+		Manager::restart(numParticles);
+		createBitStates();
+	}
+
+	void BinaryManager::iterate () {
+		if (isEnabledNoisyEvaluation()) {
+			// Re-evaluations need real positions, and the budget would reserve them anyway
+			throw std::logic_error("BinaryManager: noisy evaluation is not available");
+		}
+		if (isEnabledLazyEvaluation()) {
+			// The displacement of bit strings is not tracked
+			throw std::logic_error("BinaryManager: lazy evaluation is not available");
+		}
+		if (isEnabledDeltaEvaluation()) {
+			// Bit strings are evaluated with evaluateBits() only
+			throw std::logic_error("BinaryManager: delta evaluation is not available");
+		}
+
+		updateTopology();
+
+		for (ParticleId pid = 0; pid < numParticles(); pid++) {
+			moveBits(pid);
+		}
+
+		const Fitnesses fitnesses = evaluateBits( mPositions );
+
+		// Manager decides which particles improved, follow it for the bits
+		Fitnesses previousBest( numParticles() );
+		for (ParticleId pid = 0; pid < numParticles(); pid++) {
+			previousBest[pid] = particle(pid).best().fitness;
+		}
+
+		assignFitnesses( 0, fitnesses );
+
+		for (ParticleId pid = 0; pid < numParticles(); pid++) {
+			const Fitness fitness = particle(pid).best().fitness;
+			if (fitness < previousBest[pid]) {
+				mBests[pid] = mPositions[pid];
+				if (fitness < mBestBitsFitness) {
+					mBestBits = mPositions[pid];
+					mBestBitsFitness = fitness;
+				}
+			}
+		}
+
+		updateBestSoFar();
+
+		finishIteration();
+	}
+
+	void BinaryManager::moveBits (const ParticleId pid) {
+		const BitString& social = mBests[ socialBestId(particle(pid)) ];
+		const BitString& own = mBests[pid];
+		BitString& position = mPositions[pid];
+		Velocity& velocity = mVelocities[pid];
+
+		const VecCom inertia = static_cast<VecCom>( inertiaWeight() );
+		const VecCom cognitiveWeight = static_cast<VecCom>( this->cognitiveWeight() );
+		const VecCom socialWeight = static_cast<VecCom>( this->socialWeight() );
+		const bool isClamped = isEnabledMaxSpeedPerDimension();
+		const VecCom maxSpeed = static_cast<VecCom>( maxSpeedPerDimension() );
+
+		for (size_t w = 0; w < position.size(); w++) {
+			const BitWord current = position[w];
+
+			// Only bits that differ from a best position are attracted
+			const BitWord towardsOwn = current ^ own[w];
+			const BitWord towardsSocial = current ^ social[w];
+
+			const size_t numBitsInWord = std::min(BITS_PER_WORD, mNumBits - w * BITS_PER_WORD);
+			BitWord next = 0;
+			for (size_t b = 0; b < numBitsInWord; b++) {
+				const BitWord mask = 1ULL << b;
+				const VecCom direction = ( (current & mask) ? -1 : 1 );
+
+				VecCom v = inertia * velocity[w * BITS_PER_WORD + b];
+				if (towardsOwn & mask) {
+					v += cognitiveWeight * static_cast<VecCom>( uniform(0, 1) ) * direction;
+				}
+				if (towardsSocial & mask) {
+					v += socialWeight * static_cast<VecCom>( uniform(0, 1) ) * direction;
+				}
+				if (isClamped) {
+					v = std::max(-maxSpeed, std::min(maxSpeed, v));
+				}
+				velocity[w * BITS_PER_WORD + b] = v;
+
+				// The bit is set with probability sigmoid(v)
+				if ( uniform(0, 1) * (1.0 + std::exp(-v)) < 1.0 ) {
+					next |= mask;
+				}
+			}
+			position[w] = next;
+		}
+	}
+
+	void BinaryManager::immigrate (const Position& /*position*/, const Fitness /*fitness*/) {
+		throw std::logic_error("BinaryManager: bit strings cannot immigrate as real positions");
+	}
+
+	Fitnesses BinaryManager::evaluateFunction (const Positions& /*positions*/ ) {
+		throw std::logic_error("BinaryManager: real positions cannot be evaluated, use evaluateBits()");
+	}
+
+	size_t BinaryManager::numBits() const {
+		return mNumBits;
+	}
+
+	const BitString& BinaryManager::getBitEstimate() const {
+		return mBestBits;
+	}
+
+	const BitString& BinaryManager::bitPosition(const ParticleId pid) const {
+		return mPositions.at(pid);
+	}
+
+	const BitString& BinaryManager::bestBitPosition(const ParticleId pid) const {
+		return mBests.at(pid);
+	}
+
+	double BinaryManager::diversity() const {
+		const size_t np = mPositions.size();
+		if (np < 2) {
+			return 0;
+		}
+
+		double total = 0;
+		for (size_t i = 0; i < np; i++) {
+			for (size_t j = i + 1; j < np; j++) {
+				total += hammingDistance( mPositions[i], mPositions[j] );
+			}
+		}
+		return total / (0.5 * np * (np - 1));
+	}
+
+}; // namespace
@@ -0,0 +1,127 @@
+#ifndef INC_PSO_BINARY_H
+#define INC_PSO_BINARY_H
+
+#include <vector>
+
+#include "pso_types.h"
+#include "pso_manager.h"
+
+namespace ParticleSwarmOptimization {
+
+	// Bit strings packed 64 bits per word. Bit i is bit (i % 64) of word
+	// (i / 64). The unused high bits of the last word are always zero.
+	typedef unsigned long long BitWord;
+	typedef std::vector<BitWord> BitString;
+	typedef std::vector<BitString> BitStrings;
+
+	static const size_t BITS_PER_WORD = 64;
+
+	inline size_t numWordsFor (const size_t numBits) {
+		return (numBits + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	}
+
+	inline bool testBit (const BitString& bits, const size_t i) {
+		return ( (bits[i / BITS_PER_WORD] >> (i % BITS_PER_WORD)) & 1ULL ) != 0;
+	}
+
+	inline void setBit (BitString& bits, const size_t i, const bool value) {
+		const BitWord mask = 1ULL << (i % BITS_PER_WORD);
+		if (value) {
+			bits[i / BITS_PER_WORD] |= mask;
+		} else {
+			bits[i / BITS_PER_WORD] &= ~mask;
+		}
+	}
+
+	// Number of set bits
+	inline size_t popCount (const BitString& bits) {
+		size_t count = 0;
+		for (size_t w = 0; w < bits.size(); w++) {
+			count += __builtin_popcountll( bits[w] );
+		}
+		return count;
+	}
+
+	// Number of differing bits
+	inline size_t hammingDistance (const BitString& a, const BitString& b) {
+		size_t distance = 0;
+		for (size_t w = 0; w < a.size(); w++) {
+			distance += __builtin_popcountll( a[w] ^ b[w] );
+		}
+		return distance;
+	}
+
+	// Binary PSO (Kennedy and Eberhart). Positions are packed bit strings and
+	// every bit has a real velocity; a bit is set with probability
+	// sigmoid(velocity). The maximum speed bounds that probability and
+	// defaults to 4.
+	//
+	// The driving loop, budgets, restarts, topologies and diagnostics are
+	// those of Manager; the topology must implement socialBestId(). Inherit
+	// from this class and implement evaluateBits(), which receives the
+	// packed words. The local search, delta and lazy evaluation and
+	// opposition-based initialization work on real positions and are not
+	// available; getEstimate() and snapshot() positions are empty, use
+	// getBitEstimate() instead. Noisy evaluation is not available either;
+	// estimate() throws std::logic_error when noisy, lazy or delta
+	// evaluation is enabled.
+	class BinaryManager : public Manager {
+	public:
+		// Binary PSO with inertia 1 and cognitive and social weights of 2
+		BinaryManager (const gslseed_t seed, const size_t numBits, const size_t numParticles, const size_t numIterations);
+
+		// Linear PSO
+		BinaryManager (const gslseed_t seed, const size_t numBits, const size_t numParticles, const size_t numIterations,
+		 const Weight inertiaStart, const Weight inertiaEnd, const Weight cognitive, const Weight social);
+
+		virtual ~BinaryManager ();
+
+		size_t numBits() const;
+
+		// Best bit string so far, which survives restarts
+		const BitString& getBitEstimate() const;
+
+		const BitString& bitPosition(const ParticleId pid) const;
+		const BitString& bestBitPosition(const ParticleId pid) const;
+
+		// Mean Hamming distance between all pairs of particles
+		double diversity() const;
+
+		virtual void reset();
+		virtual void restart(const size_t numParticles);
+
+		// Migrants are real positions. Throws std::logic_error.
+		virtual void immigrate(const Position& position, const Fitness fitness);
+
+	protected:
+		virtual void iterate ();
+
+		// This should evaluate a fitness function of numBits() bits
+		virtual Fitnesses evaluateBits (const BitStrings& positions ) = 0;
+
+		// Real positions are never evaluated. Throws std::logic_error.
+		virtual Fitnesses evaluateFunction (const Positions& positions );
+
+	private:
+		BinaryManager (const BinaryManager&);
+		void operator=(const BinaryManager&);
+
+		void createBitStates ();
+		void moveBits (const ParticleId pid);
+
+		size_t mNumBits;
+
+		// Bit and velocity state, parallel to the particles of Manager, which
+		// only carry the fitnesses the topologies compare. The positions are
+		// handed to evaluateBits() as they are.
+		BitStrings mPositions;
+		BitStrings mBests;
+		std::vector<Velocity> mVelocities;
+
+		BitString mBestBits;
+		Fitness mBestBitsFitness;
+	};
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_BINARY_H
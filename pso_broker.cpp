@@ -0,0 +1,182 @@
+#include <stdexcept>
+
+#include "pso_broker.h"
+
+#include "pso_thread.h"
+
+#include "pso_timer.h"
+
+namespace ParticleSwarmOptimization {
+
+	class EvaluationBroker::Dispatcher : public Runnable {
+	public:
+		Dispatcher (EvaluationBroker* broker)
+		: mBroker(broker) {}
+
+		virtual void run () {
+			mBroker->dispatch();
+		}
+
+	private:
+		EvaluationBroker* mBroker;
+	};
+
+	EvaluationBroker::EvaluationBroker (BatchEvaluator& evaluator, const size_t maxBatchSize, const double maxLatency)
+	: mEvaluator(evaluator), mMaxBatchSize(maxBatchSize), mMaxLatency(maxLatency),
+	  mNumQueuedPoints(0), mIsStopping(false) {
+		if (mMaxBatchSize == 0) {
+			throw std::invalid_argument("EvaluationBroker: the maximum batch size must be positive");
+		}
+
+		mMutex = new Mutex();
+		mRequestQueued = new Condition();
+		mRequestDone = new Condition();
+
+		mDispatcher = new Dispatcher(this);
+		mThread = new Thread(mDispatcher);
+		mThread->start();
+	}
+
+	EvaluationBroker::~EvaluationBroker () {
+		{
+			ScopedLock lock(*mMutex);
+			mIsStopping = true;
+			mRequestQueued->signal();
+		}
+		delete mThread;
+		delete mDispatcher;
+
+		delete mRequestDone;
+		delete mRequestQueued;
+		delete mMutex;
+	}
+
+	Fitnesses EvaluationBroker::evaluate (const Positions& positions) {
+		if (positions.empty()) {
+			return Fitnesses();
+		}
+
+		Request request;
+		request.positions = &positions;
+		request.submittedAt = monotonicSeconds();
+		request.isDone = false;
+
+		ScopedLock lock(*mMutex);
+		if (mIsStopping) {
+			throw std::runtime_error("EvaluationBroker: stopped");
+		}
+		mQueue.push_back( &request );
+		mNumQueuedPoints += positions.size();
+		mRequestQueued->signal();
+
+		while (!request.isDone) {
+			mRequestDone->wait(*mMutex);
+		}
+
+		if (!request.error.empty()) {
+			throw std::runtime_error(request.error);
+		}
+		return request.fitnesses;
+	}
+
+	void EvaluationBroker::dispatch () {
+		ScopedLock lock(*mMutex);
+		for (;;) {
+			while (mQueue.empty() && !mIsStopping) {
+				mRequestQueued->wait(*mMutex);
+			}
+			if (mQueue.empty()) {
+				return;
+			}
+
+			// Wait for a full batch, at most until the oldest request is due
+			const double deadline = mQueue.front()->submittedAt + mMaxLatency;
+			for (;;) {
+				const double remaining = deadline - monotonicSeconds();
+				if ( (mNumQueuedPoints >= mMaxBatchSize) || mIsStopping || (remaining <= 0) ) {
+					break;
+				}
+				mRequestQueued->timedWait(*mMutex, remaining);
+			}
+
+			// Take whole requests in order of arrival
+			std::deque<Request*> batch;
+			size_t numPoints = 0;
+			while ( !mQueue.empty() &&
+				( batch.empty() || (numPoints + mQueue.front()->positions->size() <= mMaxBatchSize) ) ) {
+				numPoints += mQueue.front()->positions->size();
+				batch.push_back( mQueue.front() );
+				mQueue.pop_front();
+			}
+			mNumQueuedPoints -= numPoints;
+
+			const double now = monotonicSeconds();
+			for (size_t r = 0; r < batch.size(); r++) {
+				mStatistics.queueLatency.add( now - batch[r]->submittedAt );
+			}
+			mStatistics.batchSize.add( static_cast<double>(numPoints) );
+			mStatistics.numBatches++;
+			mStatistics.numRequests += batch.size();
+			mStatistics.numPoints += numPoints;
+
+			mMutex->unlock();
+			evaluateBatch(batch);
+			mMutex->lock();
+
+			for (size_t r = 0; r < batch.size(); r++) {
+				batch[r]->isDone = true;
+			}
+			mRequestDone->broadcast();
+		}
+	}
+
+	// Called without the lock. The requests are owned by their waiting
+	// threads, which only read them once they are marked done.
+	void EvaluationBroker::evaluateBatch (std::deque<Request*>& batch) {
+		Positions positions;
+		for (size_t r = 0; r < batch.size(); r++) {
+			positions.insert( positions.end(), batch[r]->positions->begin(), batch[r]->positions->end() );
+		}
+
+		std::string error;
+		Fitnesses fitnesses;
+		try {
+			fitnesses = mEvaluator.evaluate( positions );
+			if (fitnesses.size() != positions.size()) {
+				error = "EvaluationBroker: the evaluator returned the wrong number of fitnesses";
+			}
+		} catch (const std::exception& e) {
+			error = e.what();
+		}
+
+		size_t first = 0;
+		for (size_t r = 0; r < batch.size(); r++) {
+			const size_t n = batch[r]->positions->size();
+			if (error.empty()) {
+				batch[r]->fitnesses.assign( fitnesses.begin() + first, fitnesses.begin() + first + n );
+			} else {
+				batch[r]->error = error;
+			}
+			first += n;
+		}
+	}
+
+	size_t EvaluationBroker::maxBatchSize () const {
+		return mMaxBatchSize;
+	}
+
+	double EvaluationBroker::maxLatency () const {
+		return mMaxLatency;
+	}
+
+	BrokerStatistics EvaluationBroker::statistics () const {
+		ScopedLock lock(*mMutex);
+		return mStatistics;
+	}
+
+	void EvaluationBroker::resetStatistics () {
+		ScopedLock lock(*mMutex);
+		mStatistics = BrokerStatistics();
+	}
+
+}; // namespace
@@ -0,0 +1,97 @@
+#ifndef INC_PSO_BROKER_H
+#define INC_PSO_BROKER_H
+
+#include <deque>
+#include <string>
+
+#include "pso_types.h"
+#include "pso_evaluator.h"
+#include "pso_statistics.h"
+
+namespace ParticleSwarmOptimization {
+
+	class Mutex;
+	class Condition;
+	class Thread;
+
+	// Instrumentation of an EvaluationBroker
+	struct BrokerStatistics {
+		BrokerStatistics ()
+		: numBatches(0), numRequests(0), numPoints(0) {}
+
+		size_t numBatches;
+		size_t numRequests;
+		size_t numPoints;
+
+		// Points per call to the wrapped evaluator
+		RunningStatistics batchSize;
+
+		// Seconds between a request's submission and the start of its batch
+		RunningStatistics queueLatency;
+	};
+
+	// Shares one batched evaluator between many concurrent swarms. Requests
+	// from any number of threads are queued and coalesced into one call of
+	// the wrapped evaluator. A batch is dispatched as soon as the queue holds
+	// maxBatchSize points, or when the oldest request has waited maxLatency
+	// seconds. A request is never split, so a single request larger than
+	// maxBatchSize is dispatched alone.
+	//
+	// The broker is itself a BatchEvaluator. To use it from a Manager,
+	// return broker.evaluate(positions) from evaluateFunction().
+	class EvaluationBroker : public BatchEvaluator {
+	public:
+		// The evaluator is not owned. It is only called from the broker's
+		// dispatch thread.
+		EvaluationBroker (BatchEvaluator& evaluator, const size_t maxBatchSize, const double maxLatency);
+
+		// Evaluates the requests still queued, then stops
+		virtual ~EvaluationBroker ();
+
+		// Blocks until the positions have been evaluated as part of a batch.
+		// Rethrows evaluator failures as std::runtime_error.
+		virtual Fitnesses evaluate (const Positions& positions);
+
+		size_t maxBatchSize () const;
+		double maxLatency () const;
+
+		BrokerStatistics statistics () const;
+		void resetStatistics ();
+
+	private:
+		EvaluationBroker (const EvaluationBroker&);
+		void operator=(const EvaluationBroker&);
+
+		class Dispatcher;
+		friend class Dispatcher;
+
+		struct Request {
+			const Positions* positions;
+			Fitnesses fitnesses;
+			std::string error;
+			double submittedAt;
+			bool isDone;
+		};
+
+		void dispatch ();
+		void evaluateBatch (std::deque<Request*>& batch);
+
+		BatchEvaluator& mEvaluator;
+		size_t mMaxBatchSize;
+		double mMaxLatency;
+
+		Mutex* mMutex;
+		Condition* mRequestQueued;
+		Condition* mRequestDone;
+		std::deque<Request*> mQueue;
+		size_t mNumQueuedPoints;
+		bool mIsStopping;
+		BrokerStatistics mStatistics;
+
+		Dispatcher* mDispatcher;
+		Thread* mThread;
+	};
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_BROKER_H
@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "pso_c.h"
+
+#include "pso_manager.h"
+#include "pso_particle.h"
+#include "pso_topology.h"
+#include "pso_thread.h"
+
+namespace ParticleSwarmOptimization {
+
+	// Raised when the host's callback reports an error
+	class CallbackError : public std::runtime_error {
+	public:
+		CallbackError ()
+		: std::runtime_error("evaluation callback failed") {}
+	};
+
+	// A Manager evaluating through a C callback. The positions are written
+	// into one contiguous buffer that is reused from call to call.
+	class CallbackSwarm : public Manager {
+	public:
+		CallbackSwarm (const gslseed_t seed, const size_t numDimensions, const size_t numParticles, const size_t numIterations,
+		 pso_evaluate_fn evaluate, void* userData)
+		: Manager(seed, numDimensions, numParticles, numIterations), mEvaluate(evaluate), mUserData(userData) {}
+
+		CallbackSwarm (const gslseed_t seed, const size_t numDimensions, const size_t numParticles, const size_t numIterations,
+		 const Weight inertiaStart, const Weight inertiaEnd, const Weight cognitive, const Weight social,
+		 pso_evaluate_fn evaluate, void* userData)
+		: Manager(seed, numDimensions, numParticles, numIterations, inertiaStart, inertiaEnd, cognitive, social),
+		  mEvaluate(evaluate), mUserData(userData) {}
+
+		using Manager::numDimensions;
+
+	protected:
+		virtual Fitnesses evaluateCurrentPositions () {
+			const size_t np = numParticles();
+			const size_t nd = numDimensions();
+
+			mPositions.resize( np * nd );
+			for (size_t i = 0; i < np; i++) {
+				const Position& x = particle(i).current().position;
+				std::copy( x.begin(), x.end(), mPositions.begin() + i * nd );
+			}
+
+			return evaluateBuffer( np );
+		}
+
+		virtual Fitnesses evaluateFunction (const Positions& positions ) {
+			const size_t nd = numDimensions();
+
+			mPositions.resize( positions.size() * nd );
+			for (size_t i = 0; i < positions.size(); i++) {
+				std::copy( positions[i].begin(), positions[i].end(), mPositions.begin() + i * nd );
+			}
+
+			return evaluateBuffer( positions.size() );
+		}
+
+	private:
+		CallbackSwarm (const CallbackSwarm&);
+		void operator=(const CallbackSwarm&);
+
+		Fitnesses evaluateBuffer (const size_t numPoints) {
+			// Fitnesses the callback leaves unwritten count as failed
+			Fitnesses fitnesses( numPoints, FailedFitness() );
+			if (numPoints == 0) {
+				return fitnesses;
+			}
+
+			if (mEvaluate(&mPositions[0], numPoints, numDimensions(), &fitnesses[0], mUserData) != 0) {
+				throw CallbackError();
+			}
+			return fitnesses;
+		}
+
+		pso_evaluate_fn mEvaluate;
+		void* mUserData;
+
+		// Contiguous numPoints x numDimensions block handed to the callback
+		std::vector<double> mPositions;
+	};
+
+}; // namespace
+
+using namespace ParticleSwarmOptimization;
+
+struct pso_swarm {
+	pso_swarm ()
+	: manager(0) {}
+
+	CallbackSwarm* manager;
+	CancellationToken token;
+	std::string error;
+};
+
+// Runs a call on a handle, turning exceptions into status codes
+template<typename Call>
+static int guarded (pso_swarm* swarm, Call call) {
+	if (swarm == 0) {
+		return PSO_ERROR_INVALID_ARGUMENT;
+	}
+
+	try {
+		swarm->error.clear();
+		call(*swarm);
+		return PSO_OK;
+	} catch (const CallbackError& e) {
+		swarm->error = e.what();
+		return PSO_ERROR_CALLBACK;
+	} catch (const std::invalid_argument& e) {
+		swarm->error = e.what();
+		return PSO_ERROR_INVALID_ARGUMENT;
+	} catch (const std::exception& e) {
+		swarm->error = e.what();
+		return PSO_ERROR_FAILED;
+	} catch (...) {
+		swarm->error = "unknown error";
+		return PSO_ERROR_FAILED;
+	}
+}
+
+// The operations of guarded(), as function objects for C++98
+struct SetEvaluationBudget {
+	SetEvaluationBudget (const size_t budget) : mBudget(budget) {}
+	void operator()(pso_swarm& s) const { s.manager->setEvaluationBudget(mBudget); }
+	size_t mBudget;
+};
+
+struct SetTimeBudget {
+	SetTimeBudget (const double seconds) : mSeconds(seconds) {}
+	void operator()(pso_swarm& s) const {
+		if (!(mSeconds >= 0)) {
+			throw std::invalid_argument("time budget must not be negative");
+		}
+		s.manager->setTimeBudget(mSeconds);
+	}
+	double mSeconds;
+};
+
+struct SetMaxSpeed {
+	SetMaxSpeed (const double speed) : mSpeed(speed) {}
+	void operator()(pso_swarm& s) const {
+		if (!(mSpeed >= 0)) {
+			throw std::invalid_argument("maximum speed must not be negative");
+		}
+		if (mSpeed == 0) {
+			s.manager->disableMaxSpeedPerDimension();
+		} else {
+			s.manager->setMaxSpeedPerDimension(mSpeed);
+			s.manager->enableMaxSpeedPerDimension();
+		}
+	}
+	double mSpeed;
+};
+
+struct SetTargetFitness {
+	SetTargetFitness (const double target) : mTarget(target) {}
+	void operator()(pso_swarm& s) const { s.manager->setTargetFitness(mTarget); }
+	double mTarget;
+};
+
+struct UseGlobalTopology {
+	void operator()(pso_swarm& s) const { s.manager->setTopology( new GlobalTopology(s.manager) ); }
+};
+
+struct Run {
+	void operator()(pso_swarm& s) const {
+		s.manager->estimate();
+
+		// A cancellation stops one run only
+		if (s.manager->diagnostics().reason == Cancelled) {
+			s.token.reset();
+		}
+	}
+};
+
+struct Reset {
+	void operator()(pso_swarm& s) const { s.manager->reset(); }
+};
+
+static pso_swarm* createSwarm (const size_t numDimensions, const size_t numParticles, pso_evaluate_fn evaluate) {
+	if ( (numDimensions == 0) || (numParticles == 0) || (evaluate == 0) ) {
+		return 0;
+	}
+	return new (std::nothrow) pso_swarm();
+}
+
+extern "C" {
+
+int pso_api_version (void) {
+	return PSO_C_API_VERSION;
+}
+
+pso_swarm* pso_create (unsigned long seed, size_t numDimensions, size_t numParticles, size_t numIterations,
+ pso_evaluate_fn evaluate, void* userData) {
+	pso_swarm* swarm = createSwarm(numDimensions, numParticles, evaluate);
+	if (swarm == 0) {
+		return 0;
+	}
+
+	try {
+		swarm->manager = new CallbackSwarm(seed, numDimensions, numParticles, numIterations, evaluate, userData);
+	} catch (...) {
+		delete swarm;
+		return 0;
+	}
+	swarm->manager->setCancellationToken( &swarm->token );
+	return swarm;
+}
+
+pso_swarm* pso_create_linear (unsigned long seed, size_t numDimensions, size_t numParticles, size_t numIterations,
+ double inertiaStart, double inertiaEnd, double cognitive, double social,
+ pso_evaluate_fn evaluate, void* userData) {
+	pso_swarm* swarm = createSwarm(numDimensions, numParticles, evaluate);
+	if (swarm == 0) {
+		return 0;
+	}
+
+	try {
+		swarm->manager = new CallbackSwarm(seed, numDimensions, numParticles, numIterations,
+			inertiaStart, inertiaEnd, cognitive, social, evaluate, userData);
+	} catch (...) {
+		delete swarm;
+		return 0;
+	}
+	swarm->manager->setCancellationToken( &swarm->token );
+	return swarm;
+}
+
+void pso_destroy (pso_swarm* swarm) {
+	if (swarm != 0) {
+		delete swarm->manager;
+		delete swarm;
+	}
+}
+
+int pso_set_evaluation_budget (pso_swarm* swarm, size_t budget) {
+	return guarded(swarm, SetEvaluationBudget(budget));
+}
+
+int pso_set_time_budget (pso_swarm* swarm, double seconds) {
+	return guarded(swarm, SetTimeBudget(seconds));
+}
+
+int pso_set_max_speed (pso_swarm* swarm, double speed) {
+	return guarded(swarm, SetMaxSpeed(speed));
+}
+
+int pso_set_target_fitness (pso_swarm* swarm, double target) {
+	return guarded(swarm, SetTargetFitness(target));
+}
+
+int pso_use_global_topology (pso_swarm* swarm) {
+	return guarded(swarm, UseGlobalTopology());
+}
+
+int pso_run (pso_swarm* swarm) {
+	return guarded(swarm, Run());
+}
+
+int pso_cancel (pso_swarm* swarm) {
+	if (swarm == 0) {
+		return PSO_ERROR_INVALID_ARGUMENT;
+	}
+	swarm->token.cancel();
+	return PSO_OK;
+}
+
+int pso_reset (pso_swarm* swarm) {
+	return guarded(swarm, Reset());
+}
+
+int pso_get_estimate (const pso_swarm* swarm, double* position) {
+	if ( (swarm == 0) || (position == 0) ) {
+		return PSO_ERROR_INVALID_ARGUMENT;
+	}
+
+	const Position estimate = swarm->manager->getEstimate();
+	std::copy( estimate.begin(), estimate.end(), position );
+	return PSO_OK;
+}
+
+double pso_get_fitness (const pso_swarm* swarm) {
+	return (swarm != 0 ? swarm->manager->getFitness() : std::numeric_limits<double>::quiet_NaN());
+}
+
+size_t pso_num_dimensions (const pso_swarm* swarm) {
+	return (swarm != 0 ? swarm->manager->numDimensions() : 0);
+}
+
+size_t pso_num_particles (const pso_swarm* swarm) {
+	return (swarm != 0 ? swarm->manager->numParticles() : 0);
+}
+
+size_t pso_iteration (const pso_swarm* swarm) {
+	return (swarm != 0 ? swarm->manager->iteration() : 0);
+}
+
+size_t pso_num_evaluations (const pso_swarm* swarm) {
+	return (swarm != 0 ? swarm->manager->numEvaluations() : 0);
+}
+
+size_t pso_num_failed_evaluations (const pso_swarm* swarm) {
+	return (swarm != 0 ? swarm->manager->numFailedEvaluations() : 0);
+}
+
+int pso_stop_reason (const pso_swarm* swarm) {
+	if (swarm == 0) {
+		return PSO_STOP_NONE;
+	}
+
+	switch (swarm->manager->diagnostics().reason) {
+		case MaxIterationsReached:
+			return PSO_STOP_MAX_ITERATIONS;
+		case EvaluationBudgetExhausted:
+			return PSO_STOP_EVALUATION_BUDGET;
+		case TimeBudgetExhausted:
+			return PSO_STOP_TIME_BUDGET;
+		case Cancelled:
+			return PSO_STOP_CANCELLED;
+		default:
+			return PSO_STOP_NONE;
+	}
+}
+
+const char* pso_last_error (const pso_swarm* swarm) {
+	return (swarm != 0 ? swarm->error.c_str() : "invalid handle");
+}
+
+} // extern "C"
@@ -0,0 +1,102 @@
+#ifndef INC_PSO_C_H
+#define INC_PSO_C_H
+
+// C interface to the particle swarm optimizer, for embedding in other
+// languages. Only plain C types cross it and no C++ exception escapes it.
+//
+// The swarm searches the box [-1, 1]^D and minimizes. Every iteration the
+// evaluation callback receives the positions of the whole batch as one
+// contiguous, row-major block of numPoints x numDimensions doubles (the
+// coordinates of a point are consecutive), and writes numPoints fitnesses
+// into the array it is given. Both arrays are owned by the library and are
+// only valid during the call; they are reused between calls, so a host can
+// wrap them in its own array types without copying. A point whose
+// evaluation failed may be given a NaN fitness.
+//
+// A handle must not be used from two threads at once, except for
+// pso_cancel(), which may be called from any thread while pso_run() runs.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Version of this interface. Functions are only ever added.
+#define PSO_C_API_VERSION 1
+
+// Status codes
+#define PSO_OK 0
+#define PSO_ERROR_INVALID_ARGUMENT 1
+#define PSO_ERROR_CALLBACK 2
+#define PSO_ERROR_FAILED 3
+
+// Why the last run stopped, see pso_stop_reason()
+#define PSO_STOP_NONE 0
+#define PSO_STOP_MAX_ITERATIONS 1
+#define PSO_STOP_EVALUATION_BUDGET 2
+#define PSO_STOP_TIME_BUDGET 3
+#define PSO_STOP_CANCELLED 4
+
+typedef struct pso_swarm pso_swarm;
+
+// Evaluates numPoints points. Returns 0 on success; anything else aborts
+// pso_run() with PSO_ERROR_CALLBACK.
+typedef int (*pso_evaluate_fn) (const double* positions, size_t numPoints, size_t numDimensions,
+ double* fitnesses, void* userData);
+
+int pso_api_version (void);
+
+// Standard PSO. Returns NULL if an argument is invalid or memory is short.
+// userData is passed to every call of the callback and is not owned.
+pso_swarm* pso_create (unsigned long seed, size_t numDimensions, size_t numParticles, size_t numIterations,
+ pso_evaluate_fn evaluate, void* userData);
+
+// Linear PSO: the inertia weight goes from inertiaStart to inertiaEnd
+pso_swarm* pso_create_linear (unsigned long seed, size_t numDimensions, size_t numParticles, size_t numIterations,
+ double inertiaStart, double inertiaEnd, double cognitive, double social,
+ pso_evaluate_fn evaluate, void* userData);
+
+void pso_destroy (pso_swarm* swarm);
+
+// Configuration, with the meaning of the Manager methods of the same name.
+// Zero budgets mean no limit; a zero maximum speed disables the limit.
+int pso_set_evaluation_budget (pso_swarm* swarm, size_t budget);
+int pso_set_time_budget (pso_swarm* swarm, double seconds);
+int pso_set_max_speed (pso_swarm* swarm, double speed);
+int pso_set_target_fitness (pso_swarm* swarm, double target);
+
+// Every particle follows the best of the whole swarm instead of the best
+// of its ring neighbours
+int pso_use_global_topology (pso_swarm* swarm);
+
+// Runs until a stopping criterion is met. A later call continues the run,
+// e.g. after raising the budget.
+int pso_run (pso_swarm* swarm);
+
+// Asks a running pso_run() to stop after the current iteration. Called
+// between runs, it stops the next run before its first iteration.
+int pso_cancel (pso_swarm* swarm);
+
+// Starts over with a new random swarm
+int pso_reset (pso_swarm* swarm);
+
+// Copies the best position found into position, numDimensions doubles
+int pso_get_estimate (const pso_swarm* swarm, double* position);
+double pso_get_fitness (const pso_swarm* swarm);
+
+size_t pso_num_dimensions (const pso_swarm* swarm);
+size_t pso_num_particles (const pso_swarm* swarm);
+size_t pso_iteration (const pso_swarm* swarm);
+size_t pso_num_evaluations (const pso_swarm* swarm);
+size_t pso_num_failed_evaluations (const pso_swarm* swarm);
+int pso_stop_reason (const pso_swarm* swarm);
+
+// Message of the last error on this handle, or "" if there was none
+const char* pso_last_error (const pso_swarm* swarm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // #ifndef INC_PSO_C_H
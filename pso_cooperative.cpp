@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "rng.h"
+
+#include "pso_cooperative.h"
+
+#include "pso_manager.h"
+
+#include "pso_particle.h"
+
+namespace ParticleSwarmOptimization {
+
+	// The swarm optimizing the dimensions of one group
+	class CooperativeCoevolution::GroupSwarm : public Manager {
+	public:
+		GroupSwarm (CooperativeCoevolution* owner, const size_t group, const gslseed_t seed,
+		 const size_t numDimensions, const size_t numParticles, const size_t numIterations)
+		: Manager(seed, numDimensions, numParticles, numIterations), mOwner(owner), mGroup(group) {}
+
+		void step () {
+			iterate();
+		}
+
+	protected:
+		virtual Fitnesses evaluateFunction (const Positions& positions ) {
+			return mOwner->evaluateGroup(mGroup, positions);
+		}
+
+	private:
+		CooperativeCoevolution* mOwner;
+		size_t mGroup;
+	};
+
+	CooperativeCoevolution::CooperativeCoevolution (const gslseed_t seed, const size_t numDimensions, const size_t groupSize,
+	 const size_t particlesPerGroup, const size_t numCycles)
+	: mNumDimensions(numDimensions), mGroupSize(groupSize), mParticlesPerGroup(particlesPerGroup),
+	  mNumCycles(numCycles), mCycle(0), mRegroupingInterval(0), mNumEvaluations(0),
+	  mContextFitness(WorstPossibleFitness()), mIsContextEvaluated(false) {
+		if ( (mNumDimensions == 0) || (mGroupSize == 0) ) {
+			throw std::invalid_argument("CooperativeCoevolution: dimensions and group size must be positive");
+		}
+
+		mRng = new RandomNumberGenerator( seed );
+
+		mDimensions.reserve( mNumDimensions );
+		for (size_t d = 0; d < mNumDimensions; d++) {
+			mDimensions.push_back( d );
+		}
+
+		mContext.resize( mNumDimensions );
+		for (size_t d = 0; d < mNumDimensions; d++) {
+			mContext[d] = static_cast<VecCom>( mRng->uniform(-1, 1) );
+		}
+
+		createGroups();
+	}
+
+	CooperativeCoevolution::~CooperativeCoevolution () {
+		destroyGroups();
+
+		delete mRng;
+	}
+
+	void CooperativeCoevolution::setRegroupingInterval (const size_t interval) {
+		mRegroupingInterval = interval;
+	}
+
+	size_t CooperativeCoevolution::regroupingInterval () const {
+		return mRegroupingInterval;
+	}
+
+	void CooperativeCoevolution::estimate () {
+		if (!mIsContextEvaluated) {
+			initializeContext();
+		}
+
+		while (mCycle < mNumCycles) {
+			if ( (mRegroupingInterval != 0) && (mCycle != 0) && (mCycle % mRegroupingInterval == 0) ) {
+				destroyGroups();
+				shuffleDimensions();
+				createGroups();
+			}
+
+			for (size_t g = 0; g < mGroups.size(); g++) {
+				mGroups[g]->step();
+			}
+
+			mCycle++;
+		}
+	}
+
+	void CooperativeCoevolution::initializeContext () {
+		Positions positions(1, mContext);
+		const Fitnesses fitnesses = evaluateFunction( positions );
+		mNumEvaluations++;
+
+		mContextFitness = ( isFailedFitness(fitnesses.at(0)) ? WorstPossibleFitness() : fitnesses.at(0) );
+		mIsContextEvaluated = true;
+
+		// Seed every group with its part of the context vector
+		destroyGroups();
+		createGroups();
+	}
+
+	Fitnesses CooperativeCoevolution::evaluateGroup (const size_t group, const Positions& candidates) {
+		const size_t first = group * mGroupSize;
+
+		// Insert each candidate into a copy of the context vector
+		Positions positions( candidates.size(), mContext );
+		for (size_t i = 0; i < candidates.size(); i++) {
+			for (size_t k = 0; k < candidates[i].size(); k++) {
+				positions[i][ mDimensions[first + k] ] = candidates[i][k];
+			}
+		}
+
+		const Fitnesses fitnesses = evaluateFunction( positions );
+		mNumEvaluations += fitnesses.size();
+
+		// Keep the best candidate of the batch in the context vector. Like
+		// Particle, ignore candidates outside of the [-1, 1] search box.
+		size_t best = fitnesses.size();
+		for (size_t i = 0; i < fitnesses.size(); i++) {
+			if ( (fitnesses[i] < mContextFitness) && isPositionWithinBounds(candidates[i]) &&
+				( (best == fitnesses.size()) || (fitnesses[i] < fitnesses[best]) ) ) {
+				best = i;
+			}
+		}
+		if (best != fitnesses.size()) {
+			mContext.swap( positions[best] );
+			mContextFitness = fitnesses[best];
+		}
+
+		return fitnesses;
+	}
+
+	void CooperativeCoevolution::createGroups () {
+		for (size_t first = 0; first < mNumDimensions; first += mGroupSize) {
+			const size_t size = std::min(mGroupSize, mNumDimensions - first);
+			GroupSwarm* swarm = new GroupSwarm(this, mGroups.size(), mRng->randomSeed(), size, mParticlesPerGroup, mNumCycles);
+
+			if (mIsContextEvaluated) {
+				Position part( size );
+				for (size_t k = 0; k < size; k++) {
+					part[k] = mContext[ mDimensions[first + k] ];
+				}
+				swarm->immigrate(part, mContextFitness);
+			}
+
+			mGroups.push_back( swarm );
+		}
+	}
+
+	void CooperativeCoevolution::destroyGroups () {
+		while (!mGroups.empty()) {
+			delete mGroups.back();
+			mGroups.pop_back();
+		}
+	}
+
+	void CooperativeCoevolution::shuffleDimensions () {
+		// Fisher-Yates
+		for (size_t i = mDimensions.size() - 1; i > 0; i--) {
+			const size_t j = static_cast<size_t>( mRng->uniform(0, i + 1) );
+			std::swap( mDimensions[i], mDimensions[ std::min(j, i) ] );
+		}
+	}
+
+	const Position& CooperativeCoevolution::getEstimate() const {
+		return mContext;
+	}
+
+	Fitness CooperativeCoevolution::getFitness() const {
+		return mContextFitness;
+	}
+
+	size_t CooperativeCoevolution::numDimensions() const {
+		return mNumDimensions;
+	}
+
+	size_t CooperativeCoevolution::numGroups() const {
+		return mGroups.size();
+	}
+
+	size_t CooperativeCoevolution::numCycles() const {
+		return mNumCycles;
+	}
+
+	size_t CooperativeCoevolution::cycle() const {
+		return mCycle;
+	}
+
+	size_t CooperativeCoevolution::numEvaluations() const {
+		return mNumEvaluations;
+	}
+
+}; // namespace
@@ -0,0 +1,90 @@
+#ifndef INC_PSO_COOPERATIVE_H
+#define INC_PSO_COOPERATIVE_H
+
+#include <vector>
+
+#include "pso_types.h"
+
+class RandomNumberGenerator;
+
+// Seeds for GNU GSL random number generators
+// This is defined in rng.h
+typedef unsigned long int gslseed_t;
+
+namespace ParticleSwarmOptimization {
+
+	// Cooperative coevolution (CCPSO) for very high-dimensional problems.
+	//
+	// The dimensions are split into groups and every group is optimized by its
+	// own small swarm. A candidate of a group is evaluated by inserting it into
+	// a shared context vector, which holds the best known value of every
+	// dimension. Whenever a group finds a better candidate, the context vector
+	// is updated. Optionally the dimensions are randomly reassigned to groups
+	// every few cycles, so that interacting variables end up together.
+	//
+	// Inherit from this class and implement evaluateFunction(), which receives
+	// full-dimensional positions, exactly as for Manager.
+	class CooperativeCoevolution {
+	public:
+		CooperativeCoevolution (const gslseed_t seed, const size_t numDimensions, const size_t groupSize,
+		 const size_t particlesPerGroup, const size_t numCycles);
+
+		virtual ~CooperativeCoevolution ();
+
+		// Randomly regroups the dimensions every interval cycles. Zero disables it.
+		void setRegroupingInterval (const size_t interval);
+		size_t regroupingInterval () const;
+
+		// One cycle steps every group swarm once
+		void estimate ();
+
+		const Position& getEstimate() const;
+		Fitness getFitness() const;
+
+		size_t numDimensions() const;
+		size_t numGroups() const;
+		size_t numCycles() const;
+		size_t cycle() const;
+		size_t numEvaluations() const;
+
+	protected:
+		// This should evaluate a fitness function of all numDimensions() dimensions
+		virtual Fitnesses evaluateFunction (const Positions& positions ) = 0;
+
+	private:
+		CooperativeCoevolution (const CooperativeCoevolution&);
+		void operator=(const CooperativeCoevolution&);
+
+		class GroupSwarm;
+		friend class GroupSwarm;
+
+		// Evaluates the candidates of one group in the context vector
+		Fitnesses evaluateGroup (const size_t group, const Positions& candidates);
+
+		void initializeContext ();
+		void createGroups ();
+		void destroyGroups ();
+		void shuffleDimensions ();
+
+		size_t mNumDimensions;
+		size_t mGroupSize;
+		size_t mParticlesPerGroup;
+		size_t mNumCycles;
+		size_t mCycle;
+		size_t mRegroupingInterval;
+		size_t mNumEvaluations;
+
+		// Dimension indices, grouped consecutively in blocks of mGroupSize
+		std::vector<size_t> mDimensions;
+		std::vector<GroupSwarm*> mGroups;
+
+		Position mContext;
+		Fitness mContextFitness;
+		bool mIsContextEvaluated;
+
+		RandomNumberGenerator* mRng;
+	};
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_COOPERATIVE_H
@@ -0,0 +1,28 @@
+#ifndef INC_PSO_EVALUATOR_H
+#define INC_PSO_EVALUATOR_H
+
+#include "pso_types.h"
+
+namespace ParticleSwarmOptimization {
+
+	// Interface to anything that evaluates a batch of positions, with the
+	// same contract as Manager::evaluateFunction()
+	class BatchEvaluator {
+	public:
+		virtual ~BatchEvaluator() {}
+
+		virtual Fitnesses evaluate (const Positions& positions) = 0;
+	};
+
+	// Interface to an evaluator of single positions, e.g. one run of an
+	// external program. May throw to report a failed evaluation.
+	class PointEvaluator {
+	public:
+		virtual ~PointEvaluator() {}
+
+		virtual Fitness evaluate (const Position& position) = 0;
+	};
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_EVALUATOR_H
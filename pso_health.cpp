@@ -0,0 +1,59 @@
+#include <stdexcept>
+
+#include "pso_health.h"
+
+namespace ParticleSwarmOptimization {
+
+	HealthRing::HealthRing (const size_t capacity)
+	: mSlots(capacity), mWritten(0), mRead(0), mNumDropped(0) {
+		if (capacity == 0) {
+			throw std::invalid_argument("HealthRing: capacity must be positive");
+		}
+	}
+
+	// Atomic read, a full memory barrier
+	static size_t load (volatile size_t* counter) {
+		return __sync_fetch_and_add(counter, 0);
+	}
+
+	void HealthRing::publish (const SwarmHealth& health) {
+		const size_t written = load(&mWritten);
+		const size_t read = load(&mRead);
+
+		if (written - read == mSlots.size()) {
+			__sync_fetch_and_add(&mNumDropped, 1);
+			return;
+		}
+
+		// The slot was released by the consumer before it advanced mRead.
+		// Assigning into it reuses the capacity of its vectors.
+		mSlots[written % mSlots.size()] = health;
+
+		// Announces the record, after it is complete
+		__sync_fetch_and_add(&mWritten, 1);
+	}
+
+	bool HealthRing::pop (SwarmHealth& health) {
+		const size_t read = load(&mRead);
+		const size_t written = load(&mWritten);
+
+		if (read == written) {
+			return false;
+		}
+
+		health = mSlots[read % mSlots.size()];
+
+		// Hands the slot back to the producer, after it is read
+		__sync_fetch_and_add(&mRead, 1);
+		return true;
+	}
+
+	size_t HealthRing::capacity () const {
+		return mSlots.size();
+	}
+
+	size_t HealthRing::numDropped () const {
+		return load(const_cast<volatile size_t*>(&mNumDropped));
+	}
+
+}; // namespace
@@ -0,0 +1,54 @@
+#ifndef INC_PSO_HEALTH_H
+#define INC_PSO_HEALTH_H
+
+#include <vector>
+
+#include "pso_types.h"
+#include "pso_manager.h"
+
+namespace ParticleSwarmOptimization {
+
+	// Receives the SwarmHealth of every iteration, see
+	// Manager::setHealthMonitor(). publish() runs on the optimizer's thread
+	// between iterations, so it should return quickly.
+	class HealthMonitor {
+	public:
+		virtual ~HealthMonitor() {}
+
+		virtual void publish (const SwarmHealth& health) = 0;
+	};
+
+	// Bounded single-producer, single-consumer queue of SwarmHealth records.
+	// The optimizer publishes into it without locking and never blocks: when
+	// the ring is full the new record is dropped and counted. One monitoring
+	// thread drains it with pop().
+	class HealthRing : public HealthMonitor {
+	public:
+		HealthRing (const size_t capacity);
+
+		virtual void publish (const SwarmHealth& health);
+
+		// Takes the oldest record, if any. Call from one thread only.
+		bool pop (SwarmHealth& health);
+
+		size_t capacity () const;
+
+		// Records dropped because the ring was full
+		size_t numDropped () const;
+
+	private:
+		HealthRing (const HealthRing&);
+		void operator=(const HealthRing&);
+
+		std::vector<SwarmHealth> mSlots;
+
+		// Records ever written and read, accessed atomically. The producer only
+		// advances mWritten, the consumer only mRead.
+		volatile size_t mWritten;
+		volatile size_t mRead;
+		volatile size_t mNumDropped;
+	};
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_HEALTH_H
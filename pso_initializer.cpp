@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "rng.h"
+
+#include "pso_initializer.h"
+
+namespace ParticleSwarmOptimization {
+
+	// Maps a number in [0, 1) to the [-1, 1] search box
+	static VecCom toSearchBox (const double u) {
+		return static_cast<VecCom>( 2.0 * u - 1.0 );
+	}
+
+	void UniformInitializer::generate (const size_t numPoints, const size_t numDimensions,
+		RandomNumberGenerator& rng, Positions& points) {
+		points.reserve( points.size() + numPoints );
+		for (size_t i = 0; i < numPoints; i++) {
+			Position pos( numDimensions );
+			for (size_t d = 0; d < numDimensions; d++) {
+				pos[d] = static_cast<VecCom>( rng.uniform(-1, 1) );
+			}
+			points.push_back( pos );
+		}
+	}
+
+	void LatinHypercubeInitializer::generate (const size_t numPoints, const size_t numDimensions,
+		RandomNumberGenerator& rng, Positions& points) {
+		const size_t first = points.size();
+		points.resize( first + numPoints, Position(numDimensions) );
+
+		std::vector<size_t> strata( numPoints );
+		for (size_t d = 0; d < numDimensions; d++) {
+			for (size_t i = 0; i < numPoints; i++) {
+				strata[i] = i;
+			}
+
+			// Fisher-Yates
+			for (size_t i = numPoints; i > 1; i--) {
+				const size_t j = std::min( static_cast<size_t>(rng.uniform(0, i)), i - 1 );
+				std::swap( strata[i - 1], strata[j] );
+			}
+
+			for (size_t i = 0; i < numPoints; i++) {
+				const double u = (strata[i] + rng.uniform()) / numPoints;
+				points[first + i][d] = toSearchBox(u);
+			}
+		}
+	}
+
+	void SobolInitializer::generate (const size_t numPoints, const size_t numDimensions,
+		RandomNumberGenerator& rng, Positions& points) {
+		if (numPoints >= (1UL << NUM_BITS) - 1) {
+			throw std::invalid_argument("SobolInitializer: too many points");
+		}
+
+		// Dimension 0 is the van der Corput sequence, the others each use a
+		// distinct primitive polynomial
+		std::vector<Polynomial> polynomials;
+		if (numDimensions > 1) {
+			primitivePolynomials( numDimensions - 1, polynomials );
+		}
+
+		std::vector<Directions> v( numDimensions );
+		std::vector<unsigned long> shift( numDimensions );
+		for (size_t d = 0; d < numDimensions; d++) {
+			if (d == 0) {
+				v[d].resize( NUM_BITS );
+				for (size_t k = 0; k < NUM_BITS; k++) {
+					v[d][k] = 1UL << (NUM_BITS - 1 - k);
+				}
+			} else {
+				directions( polynomials[d - 1], rng, v[d] );
+			}
+			shift[d] = static_cast<unsigned long>( rng.uniform() * 4294967296.0 ) & 0xffffffffUL;
+		}
+
+		// Gray code construction. The digital shift moves the all-zero first
+		// point away from the corner, so it is kept.
+		const double scale = 1.0 / 4294967296.0;
+		std::vector<unsigned long> x( numDimensions, 0 );
+		const size_t first = points.size();
+		points.resize( first + numPoints, Position(numDimensions) );
+		for (size_t i = 0; i < numPoints; i++) {
+			// Index of the lowest zero bit of i, the direction to the next point
+			size_t c = 0;
+			while ( (i >> c) & 1 ) {
+				c++;
+			}
+
+			Position& pos = points[first + i];
+			for (size_t d = 0; d < numDimensions; d++) {
+				pos[d] = toSearchBox( (x[d] ^ shift[d]) * scale );
+				x[d] ^= v[d][c];
+			}
+		}
+	}
+
+	void SobolInitializer::primitivePolynomials (const size_t count, std::vector<Polynomial>& polynomials) {
+		// Polynomials of degree s have bit s and the constant term set
+		for (size_t degree = 1; polynomials.size() < count; degree++) {
+			if (degree >= NUM_BITS) {
+				throw std::invalid_argument("SobolInitializer: too many dimensions");
+			}
+			for (Polynomial middle = 0; (middle < (1ULL << (degree - 1))) && (polynomials.size() < count); middle++) {
+				const Polynomial p = (1ULL << degree) | (middle << 1) | 1ULL;
+				if (isPrimitive(p, degree)) {
+					polynomials.push_back( p );
+				}
+			}
+		}
+	}
+
+	// Multiplication of polynomials over GF(2) modulo p
+	static unsigned long long multiplyMod (unsigned long long a, unsigned long long b,
+		const unsigned long long p, const size_t degree) {
+		unsigned long long result = 0;
+		while (b != 0) {
+			if (b & 1) {
+				result ^= a;
+			}
+			b >>= 1;
+			a <<= 1;
+			if ( (a >> degree) & 1 ) {
+				a ^= p;
+			}
+		}
+		return result;
+	}
+
+	// x^e modulo p over GF(2)
+	static unsigned long long powerOfX (unsigned long long e, const unsigned long long p, const size_t degree) {
+		unsigned long long result = 1;
+		unsigned long long base = (degree > 1 ? 2ULL : (2ULL ^ p));
+		while (e != 0) {
+			if (e & 1) {
+				result = multiplyMod(result, base, p, degree);
+			}
+			base = multiplyMod(base, base, p, degree);
+			e >>= 1;
+		}
+		return result;
+	}
+
+	// p is primitive iff x has multiplicative order 2^degree - 1 modulo p
+	bool SobolInitializer::isPrimitive (const Polynomial p, const size_t degree) {
+		const unsigned long long order = (1ULL << degree) - 1;
+		if (powerOfX(order, p, degree) != 1) {
+			return false;
+		}
+
+		unsigned long long rest = order;
+		for (unsigned long long q = 2; q * q <= rest; q++) {
+			if (rest % q == 0) {
+				if (powerOfX(order / q, p, degree) == 1) {
+					return false;
+				}
+				while (rest % q == 0) {
+					rest /= q;
+				}
+			}
+		}
+		if ( (rest > 1) && (rest != order) && (powerOfX(order / rest, p, degree) == 1) ) {
+			return false;
+		}
+		return true;
+	}
+
+	size_t SobolInitializer::degreeOf (const Polynomial p) {
+		size_t degree = 0;
+		while ( (p >> (degree + 1)) != 0 ) {
+			degree++;
+		}
+		return degree;
+	}
+
+	void SobolInitializer::directions (const Polynomial p, RandomNumberGenerator& rng, Directions& v) {
+		const size_t s = degreeOf(p);
+
+		// m[k] is odd and smaller than 2^(k+1)
+		std::vector<unsigned long> m( NUM_BITS );
+		for (size_t k = 0; k < NUM_BITS; k++) {
+			if (k < s) {
+				const unsigned long range = 1UL << k;
+				m[k] = 2 * std::min( static_cast<unsigned long>(rng.uniform(0, range)), range - 1 ) + 1;
+			} else {
+				m[k] = m[k - s] ^ (m[k - s] << s);
+				for (size_t i = 1; i < s; i++) {
+					if ( (p >> (s - i)) & 1 ) {
+						m[k] ^= m[k - i] << i;
+					}
+				}
+			}
+		}
+
+		v.resize( NUM_BITS );
+		for (size_t k = 0; k < NUM_BITS; k++) {
+			v[k] = (m[k] << (NUM_BITS - 1 - k)) & 0xffffffffUL;
+		}
+	}
+
+}; // namespace
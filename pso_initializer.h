@@ -0,0 +1,71 @@
+#ifndef INC_PSO_INITIALIZER_H
+#define INC_PSO_INITIALIZER_H
+
+#include <vector>
+
+#include "pso_types.h"
+
+class RandomNumberGenerator;
+
+namespace ParticleSwarmOptimization {
+
+	// Interface to all initial position generators. Points are generated in
+	// bulk and must lie in the [-1, 1] search box.
+	class Initializer {
+	public:
+		virtual ~Initializer() {}
+
+		// Appends numPoints points of numDimensions dimensions to points
+		virtual void generate (const size_t numPoints, const size_t numDimensions,
+			RandomNumberGenerator& rng, Positions& points) = 0;
+
+		// True if the points may already be good solutions. The manager then
+		// evaluates them before the particles first move, so that they
+		// become the particles' bests.
+		virtual bool isSeeded () const {
+			return false;
+		}
+	};
+
+	// Independent uniform draws per dimension
+	class UniformInitializer : public Initializer {
+	public:
+		virtual void generate (const size_t numPoints, const size_t numDimensions,
+			RandomNumberGenerator& rng, Positions& points);
+	};
+
+	// Latin hypercube: every dimension is split into numPoints strata and
+	// each stratum holds exactly one point
+	class LatinHypercubeInitializer : public Initializer {
+	public:
+		virtual void generate (const size_t numPoints, const size_t numDimensions,
+			RandomNumberGenerator& rng, Positions& points);
+	};
+
+	// Sobol low-discrepancy sequence. The primitive polynomials are found on
+	// demand, so any number of dimensions is supported. The initial direction
+	// numbers are drawn at random and every dimension gets a random digital
+	// shift, which scrambles the sequence while keeping its stratification.
+	class SobolInitializer : public Initializer {
+	public:
+		virtual void generate (const size_t numPoints, const size_t numDimensions,
+			RandomNumberGenerator& rng, Positions& points);
+
+	private:
+		typedef unsigned long long Polynomial;
+
+		// Direction numbers of one dimension
+		typedef std::vector<unsigned long> Directions;
+
+		static const size_t NUM_BITS = 32;
+
+		static void primitivePolynomials (const size_t count, std::vector<Polynomial>& polynomials);
+		static bool isPrimitive (const Polynomial p, const size_t degree);
+		static size_t degreeOf (const Polynomial p);
+
+		static void directions (const Polynomial p, RandomNumberGenerator& rng, Directions& v);
+	};
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_INITIALIZER_H
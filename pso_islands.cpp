@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "pso_islands.h"
+
+#include "pso_manager.h"
+
+#include "pso_particle.h"
+
+#include "pso_thread.h"
+
+namespace ParticleSwarmOptimization {
+
+	// Drives one island on its own thread
+	class IslandModel::IslandRunner : public Runnable {
+	public:
+		IslandRunner (IslandModel* model, const size_t index)
+		: mModel(model), mIndex(index), mFailed(false) {}
+
+		virtual void run () {
+			try {
+				mModel->runIsland(mIndex);
+			} catch (const std::exception& e) {
+				mFailed = true;
+				mError = e.what();
+			}
+		}
+
+		bool failed() const {
+			return mFailed;
+		}
+
+		const std::string& error() const {
+			return mError;
+		}
+
+	private:
+		IslandModel* mModel;
+		size_t mIndex;
+		bool mFailed;
+		std::string mError;
+	};
+
+	IslandModel::IslandModel (const size_t migrationInterval)
+	: mMigrationInterval(migrationInterval), mNumMigrations(0) {
+		if (mMigrationInterval == 0) {
+			throw std::invalid_argument("IslandModel: migration interval must be positive");
+		}
+	}
+
+	IslandModel::~IslandModel () {
+		clearMailboxes();
+
+		while (!mRoutes.empty()) {
+			delete mRoutes.back();
+			mRoutes.pop_back();
+		}
+	}
+
+	size_t IslandModel::addIsland (Manager* island) {
+		if (island->getEstimate().empty()) {
+			throw std::invalid_argument("IslandModel: the island has no real positions to migrate");
+		}
+		mIslands.push_back(island);
+		return mIslands.size() - 1;
+	}
+
+	void IslandModel::addMigrationRoute (const size_t from, const size_t to) {
+		if ( (from >= mIslands.size()) || (to >= mIslands.size()) || (from == to) ) {
+			throw std::invalid_argument("IslandModel: invalid migration route");
+		}
+		mRoutes.push_back( new Route(from, to) );
+	}
+
+	void IslandModel::connectRing () {
+		if (mIslands.size() < 2) {
+			return;
+		}
+		for (size_t i = 0; i < mIslands.size(); i++) {
+			addMigrationRoute( i, (i + 1) % mIslands.size() );
+		}
+	}
+
+	void IslandModel::connectFully () {
+		for (size_t i = 0; i < mIslands.size(); i++) {
+			for (size_t j = 0; j < mIslands.size(); j++) {
+				if (i != j) {
+					addMigrationRoute(i, j);
+				}
+			}
+		}
+	}
+
+	void IslandModel::estimate () {
+		clearMailboxes();
+		mNumMigrations = 0;
+
+		std::vector<IslandRunner*> runners;
+		std::vector<Thread*> threads;
+		for (size_t i = 0; i < mIslands.size(); i++) {
+			runners.push_back( new IslandRunner(this, i) );
+			threads.push_back( new Thread(runners.back()) );
+		}
+
+		for (size_t i = 0; i < threads.size(); i++) {
+			threads[i]->start();
+		}
+
+		std::string error;
+		for (size_t i = 0; i < threads.size(); i++) {
+			threads[i]->join();
+			if (runners[i]->failed() && error.empty()) {
+				error = runners[i]->error();
+			}
+			delete threads[i];
+			delete runners[i];
+		}
+
+		if (!error.empty()) {
+			throw std::runtime_error(error);
+		}
+	}
+
+	void IslandModel::runIsland (const size_t index) {
+		Manager* island = mIslands[index];
+		island->beginRun();
+		while (island->keepLooping()) {
+			island->iterate();
+
+			if ( (island->iteration() % mMigrationInterval) == 0 ) {
+				emigrate(index);
+				immigrate(index);
+			}
+		}
+	}
+
+	void IslandModel::emigrate (const size_t index) {
+		const Manager* island = mIslands[index];
+		const Position position = island->getEstimate();
+		const Fitness fitness = island->getFitness();
+
+		for (size_t r = 0; r < mRoutes.size(); r++) {
+			if (mRoutes[r]->from == index) {
+				Migrant* stale = atomicExchange(&mRoutes[r]->mailbox, new Migrant(position, fitness));
+				delete stale;
+			}
+		}
+	}
+
+	void IslandModel::immigrate (const size_t index) {
+		Manager* island = mIslands[index];
+
+		for (size_t r = 0; r < mRoutes.size(); r++) {
+			if (mRoutes[r]->to == index) {
+				Migrant* migrant = atomicExchange(&mRoutes[r]->mailbox, static_cast<Migrant*>(0));
+				if (migrant != 0) {
+					island->immigrate(migrant->position, migrant->fitness);
+					__sync_fetch_and_add(&mNumMigrations, 1);
+					delete migrant;
+				}
+			}
+		}
+	}
+
+	void IslandModel::clearMailboxes () {
+		for (size_t r = 0; r < mRoutes.size(); r++) {
+			delete mRoutes[r]->mailbox;
+			mRoutes[r]->mailbox = 0;
+		}
+	}
+
+	const Manager& IslandModel::bestIsland() const {
+		if (mIslands.empty()) {
+			throw std::runtime_error("IslandModel: no islands");
+		}
+
+		size_t best = 0;
+		for (size_t i = 1; i < mIslands.size(); i++) {
+			if (mIslands[i]->getFitness() < mIslands[best]->getFitness()) {
+				best = i;
+			}
+		}
+		return *mIslands[best];
+	}
+
+	Position IslandModel::getEstimate() const {
+		return bestIsland().getEstimate();
+	}
+
+	Fitness IslandModel::getFitness() const {
+		return bestIsland().getFitness();
+	}
+
+	size_t IslandModel::numIslands() const {
+		return mIslands.size();
+	}
+
+	const Manager& IslandModel::island(const size_t index) const {
+		return *mIslands.at(index);
+	}
+
+	size_t IslandModel::migrationInterval() const {
+		return mMigrationInterval;
+	}
+
+	size_t IslandModel::numMigrations() const {
+		return mNumMigrations;
+	}
+
+}; // namespace
@@ -0,0 +1,95 @@
+#ifndef INC_PSO_ISLANDS_H
+#define INC_PSO_ISLANDS_H
+
+#include <vector>
+
+#include "pso_types.h"
+
+namespace ParticleSwarmOptimization {
+
+	class Manager;
+
+	// Runs several independent swarms (islands), each on its own thread.
+	// Every migration interval an island posts its best particle to the
+	// mailboxes of its neighbours in the migration graph, and adopts any
+	// immigrants waiting in its own mailboxes. Mailboxes are single-slot
+	// and lock-free: a newer migrant simply replaces an unread older one.
+	//
+	// Each island is a fully configured Manager (weights, topology and seed
+	// are its own). The islands are not owned by the model and must outlive it.
+	// Migrants are real positions, so islands without them, such as
+	// BinaryManager, are rejected.
+	class IslandModel {
+	public:
+		IslandModel (const size_t migrationInterval);
+
+		~IslandModel ();
+
+		// Returns the island index
+		size_t addIsland (Manager* island);
+
+		// Adds a directed migration route
+		void addMigrationRoute (const size_t from, const size_t to);
+
+		// Connects the islands added so far in a unidirectional ring
+		void connectRing ();
+
+		// Connects every island to every other island
+		void connectFully ();
+
+		// Runs all islands to completion, one thread per island
+		void estimate ();
+
+		Position getEstimate() const;
+		Fitness  getFitness() const;
+
+		size_t numIslands() const;
+		const Manager& island(const size_t index) const;
+
+		size_t migrationInterval() const;
+
+		// Number of migrants adopted by all islands during the last estimate
+		size_t numMigrations() const;
+
+	private:
+		IslandModel (const IslandModel&);
+		void operator=(const IslandModel&);
+
+		struct Migrant {
+			Migrant (const Position& p, const Fitness f)
+			: position(p), fitness(f) {}
+
+			Position position;
+			Fitness fitness;
+		};
+
+		struct Route {
+			Route (const size_t f, const size_t t)
+			: from(f), to(t), mailbox(0) {}
+
+			size_t from;
+			size_t to;
+			Migrant* volatile mailbox;
+		};
+
+		class IslandRunner;
+		friend class IslandRunner;
+
+		void runIsland (const size_t index);
+		void emigrate (const size_t index);
+		void immigrate (const size_t index);
+
+		void clearMailboxes ();
+
+		const Manager& bestIsland() const;
+
+		size_t mMigrationInterval;
+		std::vector<Manager*> mIslands;
+		std::vector<Route*> mRoutes;
+
+		volatile size_t mNumMigrations;
+	};
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_ISLANDS_H
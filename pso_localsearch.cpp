@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "pso_localsearch.h"
+
+#include "pso_evaluator.h"
+
+namespace ParticleSwarmOptimization {
+
+	PatternSearch::PatternSearch (const double initialStep, const double minStep)
+	: mInitialStep(initialStep), mMinStep(minStep), mStep(initialStep) {
+	}
+
+	void PatternSearch::refine (Position& position, Fitness& fitness, BatchEvaluator& evaluator, const size_t maxEvaluations) {
+		const size_t pollSize = 2 * position.size();
+		if (pollSize == 0) {
+			return;
+		}
+
+		size_t used = 0;
+		while (used + pollSize <= maxEvaluations) {
+			if (mStep < mMinStep) {
+				mStep = mInitialStep;
+			}
+
+			Positions poll( pollSize, position );
+			for (size_t d = 0; d < position.size(); d++) {
+				poll[2 * d][d] += static_cast<VecCom>( mStep );
+				poll[2 * d + 1][d] -= static_cast<VecCom>( mStep );
+			}
+
+			const Fitnesses fitnesses = evaluator.evaluate( poll );
+			used += pollSize;
+
+			const size_t best = std::min_element(fitnesses.begin(), fitnesses.end()) - fitnesses.begin();
+			if (fitnesses[best] < fitness) {
+				position = poll[best];
+				fitness = fitnesses[best];
+			} else {
+				mStep *= 0.5;
+			}
+		}
+	}
+
+	NelderMead::NelderMead (const double initialStep)
+	: mInitialStep(initialStep) {
+	}
+
+	typedef std::pair<Fitness, Position> Vertex;
+
+	static bool vertexLess (const Vertex& a, const Vertex& b) {
+		return a.first < b.first;
+	}
+
+	// x + t * (y - x)
+	static Position towards (const Position& x, const Position& y, const double t) {
+		Position z( x.size() );
+		for (size_t d = 0; d < x.size(); d++) {
+			z[d] = static_cast<VecCom>( x[d] + t * (y[d] - x[d]) );
+		}
+		return z;
+	}
+
+	void NelderMead::refine (Position& position, Fitness& fitness, BatchEvaluator& evaluator, const size_t maxEvaluations) {
+		const size_t n = position.size();
+		if ( (n == 0) || (maxEvaluations < n + 1) ) {
+			return;
+		}
+
+		// Initial simplex in one batch
+		Positions initial( n, position );
+		for (size_t d = 0; d < n; d++) {
+			initial[d][d] += static_cast<VecCom>( mInitialStep );
+		}
+		Fitnesses fitnesses = evaluator.evaluate( initial );
+		size_t used = n;
+
+		std::vector<Vertex> simplex;
+		simplex.push_back( Vertex(fitness, position) );
+		for (size_t d = 0; d < n; d++) {
+			simplex.push_back( Vertex(fitnesses[d], initial[d]) );
+		}
+
+		Positions single( 1 );
+		while (used + 2 <= maxEvaluations) {
+			std::sort( simplex.begin(), simplex.end(), vertexLess );
+
+			// Centroid of all but the worst vertex
+			Position centroid( n, 0 );
+			for (size_t i = 0; i < n; i++) {
+				for (size_t d = 0; d < n; d++) {
+					centroid[d] += simplex[i].second[d] / n;
+				}
+			}
+			Vertex& worst = simplex[n];
+
+			single[0] = towards( centroid, worst.second, -1.0 );
+			const Fitness fr = evaluator.evaluate( single ).at(0);
+			used++;
+			const Position reflected = single[0];
+
+			if (fr < simplex[0].first) {
+				// Try to expand
+				single[0] = towards( centroid, worst.second, -2.0 );
+				const Fitness fe = evaluator.evaluate( single ).at(0);
+				used++;
+				worst = (fe < fr ? Vertex(fe, single[0]) : Vertex(fr, reflected));
+			} else if (fr < simplex[n - 1].first) {
+				worst = Vertex(fr, reflected);
+			} else {
+				// Contract towards the better of the worst and reflected points
+				const bool outside = (fr < worst.first);
+				single[0] = towards( centroid, worst.second, outside ? -0.5 : 0.5 );
+				const Fitness fc = evaluator.evaluate( single ).at(0);
+				used++;
+
+				if (fc < std::min(fr, worst.first)) {
+					worst = Vertex(fc, single[0]);
+				} else if (used + n <= maxEvaluations) {
+					// Shrink towards the best vertex, as one batch
+					Positions shrunk;
+					for (size_t i = 1; i <= n; i++) {
+						shrunk.push_back( towards(simplex[0].second, simplex[i].second, 0.5) );
+					}
+					fitnesses = evaluator.evaluate( shrunk );
+					used += n;
+					for (size_t i = 1; i <= n; i++) {
+						simplex[i] = Vertex(fitnesses[i - 1], shrunk[i - 1]);
+					}
+				} else {
+					break;
+				}
+			}
+		}
+
+		const std::vector<Vertex>::const_iterator best = std::min_element( simplex.begin(), simplex.end(), vertexLess );
+		if (best->first < fitness) {
+			position = best->second;
+			fitness = best->first;
+		}
+	}
+
+}; // namespace
@@ -0,0 +1,51 @@
+#ifndef INC_PSO_LOCALSEARCH_H
+#define INC_PSO_LOCALSEARCH_H
+
+#include "pso_types.h"
+
+namespace ParticleSwarmOptimization {
+
+	class BatchEvaluator;
+
+	// Interface to local optimizers used to refine the swarm best, see
+	// Manager::setLocalSearch()
+	class LocalSearch {
+	public:
+		virtual ~LocalSearch() {}
+
+		// Improves position and fitness in place, passing at most
+		// maxEvaluations positions to the evaluator
+		virtual void refine (Position& position, Fitness& fitness, BatchEvaluator& evaluator, const size_t maxEvaluations) = 0;
+	};
+
+	// Compass search: polls both directions of every dimension in one batch,
+	// moves to the best improving point and halves the step when none
+	// improves. The step is kept between calls and starts over once it
+	// falls below the minimum.
+	class PatternSearch : public LocalSearch {
+	public:
+		PatternSearch (const double initialStep = 0.1, const double minStep = 1e-9);
+
+		virtual void refine (Position& position, Fitness& fitness, BatchEvaluator& evaluator, const size_t maxEvaluations);
+
+	private:
+		double mInitialStep;
+		double mMinStep;
+		double mStep;
+	};
+
+	// Nelder-Mead downhill simplex around the given point. The initial
+	// simplex and shrink steps are evaluated as one batch each.
+	class NelderMead : public LocalSearch {
+	public:
+		NelderMead (const double initialStep = 0.05);
+
+		virtual void refine (Position& position, Fitness& fitness, BatchEvaluator& evaluator, const size_t maxEvaluations);
+
+	private:
+		double mInitialStep;
+	};
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_LOCALSEARCH_H
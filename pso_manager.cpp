@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <functional>
 
 #include "rng.h"
@@ -10,10 +11,27 @@
 
 #include "pso_inertiascaling.h"
 
+#include "pso_restart.h"
+
+#include "pso_initializer.h"
+
+#include "pso_localsearch.h"
+
+#include "pso_evaluator.h"
+
+#include "pso_thread.h"
+
+#include "pso_timer.h"
+
+#include "pso_health.h"
+
 #include <iostream>
 
+#include <cmath>
 #include <cstddef>
 #include <limits>
+#include <stdexcept>
+#include <utility>
 
 namespace ParticleSwarmOptimization {
 
@@ -21,6 +39,14 @@ namespace ParticleSwarmOptimization {
 		return std::numeric_limits<Fitness>::max();
 	}
 
+	Fitness FailedFitness() {
+		return std::numeric_limits<Fitness>::quiet_NaN();
+	}
+
+	bool isFailedFitness(const Fitness fitness) {
+		return (fitness != fitness);
+	}
+
 	class ParticleBestFitnessCmpp {
 		public:
 			bool operator()(const Particle* const a, const Particle* const b) const {
@@ -31,8 +57,51 @@ namespace ParticleSwarmOptimization {
 	};
 
 
+	// Lets a local search evaluate through the manager, counting the
+	// evaluations and rejecting points outside of the search box unevaluated
+	class Manager::RefinementEvaluator : public BatchEvaluator {
+	public:
+		RefinementEvaluator (Manager* manager)
+		: mManager(manager) {}
+
+		virtual Fitnesses evaluate (const Positions& positions) {
+			Positions inside;
+			for (size_t i = 0; i < positions.size(); i++) {
+				if (isPositionWithinBounds(positions[i])) {
+					inside.push_back( positions[i] );
+				}
+			}
+
+			Fitnesses evaluated;
+			if (!inside.empty()) {
+				evaluated = mManager->evaluateFunction( inside );
+				mManager->mNumEvaluations += inside.size();
+				mManager->countFailedEvaluations( evaluated );
+			}
+
+			// Failed evaluations are reported as the worst fitness
+			Fitnesses fitnesses( positions.size(), WorstPossibleFitness() );
+			for (size_t i = 0, k = 0; i < positions.size(); i++) {
+				if (isPositionWithinBounds(positions[i])) {
+					const Fitness fitness = evaluated.at(k++);
+					if (!isFailedFitness(fitness)) {
+						fitnesses[i] = fitness;
+					}
+				}
+			}
+			return fitnesses;
+		}
+
+	private:
+		Manager* mManager;
+	};
+
 	Manager::Manager ( const gslseed_t seed, const size_t numDimensions, const size_t numParticles, const size_t numIterations )
-	: mNumDimensions(numDimensions), mNumIterations(numIterations), mIterationCount(0), mInertia(0) {
+	: mNumDimensions(numDimensions), mNumIterations(numIterations), mIterationCount(0), mInertia(0),
+	  mInitialNumParticles(numParticles), mNumEvaluations(0), mEvaluationBudget(0), mNumRestarts(0), mRestart(0),
+	  mBestFitness(WorstPossibleFitness()),
+	  mTimeBudget(0), mRunStart(monotonicSeconds()), mRunStop(mRunStart), mCancellationToken(0), mStopReason(NotStopped) {
+		mSnapshotMutex = new Mutex();
 		mRng = new RandomNumberGenerator( seed );
 
 		mTopology = new RingTopology (this);
@@ -48,12 +117,41 @@ namespace ParticleSwarmOptimization {
 		setMaxSpeedPerDimension(0.5);
 		enableMaxSpeedPerDimension();
 
+		mIsEnabledDeltaEvaluation = false;
+		mNumDeltaEvaluations = 0;
+		mNumFailedEvaluations = 0;
+
+		mIsEnabledLazyEvaluation = false;
+		mLazyEvaluationTolerance = 0;
+		mNumSkippedEvaluations = 0;
+
+		mIsEnabledNoisyEvaluation = false;
+		mReevaluationsPerIteration = 0;
+		mNumReevaluations = 0;
+
+		mLocalSearch = 0;
+		mLocalSearchInterval = 0;
+		mLocalSearchEvaluations = 0;
+
+		mInitializer = 0;
+		mIsEnabledOppositionBasedInitialization = false;
+
+		mHasTarget = false;
+		mTargetFitness = WorstPossibleFitness();
+		mEvaluationsToTarget = 0;
+
+		mHealthMonitor = 0;
+
 		createParticles( numParticles );
 	}
 
 	Manager::Manager (const gslseed_t seed, const size_t numDimensions, const size_t numParticles, const size_t numIterations,
 		 const Weight inertiaStart, const Weight inertiaEnd, const Weight cognitive, const Weight social)
-	: mNumDimensions(numDimensions), mNumIterations(numIterations), mIterationCount(0), mInertia(0) {
+	: mNumDimensions(numDimensions), mNumIterations(numIterations), mIterationCount(0), mInertia(0),
+	  mInitialNumParticles(numParticles), mNumEvaluations(0), mEvaluationBudget(0), mNumRestarts(0), mRestart(0),
+	  mBestFitness(WorstPossibleFitness()),
+	  mTimeBudget(0), mRunStart(monotonicSeconds()), mRunStop(mRunStart), mCancellationToken(0), mStopReason(NotStopped) {
+		mSnapshotMutex = new Mutex();
 		mRng = new RandomNumberGenerator( seed );
 
 		mTopology = new RingTopology (this);
@@ -66,22 +164,158 @@ namespace ParticleSwarmOptimization {
 		setMaxSpeedPerDimension(0.5);
 		enableMaxSpeedPerDimension();
 
+		mIsEnabledDeltaEvaluation = false;
+		mNumDeltaEvaluations = 0;
+		mNumFailedEvaluations = 0;
+
+		mIsEnabledLazyEvaluation = false;
+		mLazyEvaluationTolerance = 0;
+		mNumSkippedEvaluations = 0;
+
+		mIsEnabledNoisyEvaluation = false;
+		mReevaluationsPerIteration = 0;
+		mNumReevaluations = 0;
+
+		mLocalSearch = 0;
+		mLocalSearchInterval = 0;
+		mLocalSearchEvaluations = 0;
+
+		mInitializer = 0;
+		mIsEnabledOppositionBasedInitialization = false;
+
+		mHasTarget = false;
+		mTargetFitness = WorstPossibleFitness();
+		mEvaluationsToTarget = 0;
+
+		mHealthMonitor = 0;
+
 		createParticles( numParticles );
 	}
 
 	Manager::~Manager () {
 		destroyParticles();
 
+		delete mSnapshotMutex;
+		delete mLocalSearch;
+		delete mInitializer;
+		delete mRestart;
+		delete mTopology;
+		delete mInertia;
 		delete mRng;
 	}
 
 	void Manager::createParticles(const size_t numParticles) {
 		// Initialize the particles
 		mParticles.reserve( numParticles );
-		for (size_t i = 0; i < numParticles; i++) {
-			Particle* p = new Particle ( this, Particle::State(randomPosition(), randomVelocity()), genUniqueId() );
-			mParticles.push_back( p );
+		if (mInitializer == 0) {
+			for (size_t i = 0; i < numParticles; i++) {
+				Particle* p = new Particle ( this, Particle::State(randomPosition(), randomVelocity()), genUniqueId() );
+				mParticles.push_back( p );
+			}
+		} else {
+			// Generate all positions in bulk
+			Positions positions;
+			mInitializer->generate( numParticles, numDimensions(), *mRng, positions );
+			for (size_t i = 0; i < numParticles; i++) {
+				Particle* p = new Particle ( this, Particle::State(positions[i], randomVelocity()), genUniqueId() );
+				mParticles.push_back( p );
+			}
 		}
+
+		mIsSwarmPrepared = false;
+	}
+
+	void Manager::prepareParticles() {
+		if (mIsSwarmPrepared) {
+			return;
+		}
+		mIsSwarmPrepared = true;
+
+		if (mIsEnabledOppositionBasedInitialization) {
+			initializeByOpposition();
+		} else if ( (mInitializer != 0) && mInitializer->isSeeded() ) {
+			evaluateInitialPositions();
+		}
+	}
+
+	size_t Manager::preparationEvaluations() const {
+		if (mIsSwarmPrepared) {
+			return 0;
+		}
+		if (mIsEnabledOppositionBasedInitialization) {
+			return 2 * numParticles();
+		}
+		if ( (mInitializer != 0) && mInitializer->isSeeded() ) {
+			return numParticles();
+		}
+		return 0;
+	}
+
+	void Manager::evaluateInitialPositions() {
+		Positions positions;
+		for (size_t i = 0; i < mParticles.size(); i++) {
+			positions.push_back( mParticles[i]->current().position );
+		}
+
+		assignFitnesses( 0, evaluateFunction(positions) );
+		updateBestSoFar();
+	}
+
+	void Manager::initializeByOpposition() {
+		// Candidates followed by their opposites, in one batch
+		const size_t np = numParticles();
+		Positions positions;
+		positions.reserve( 2 * np );
+		for (size_t i = 0; i < np; i++) {
+			positions.push_back( mParticles[i]->current().position );
+		}
+		for (size_t i = 0; i < np; i++) {
+			Position opposite( positions[i] );
+			for (size_t d = 0; d < opposite.size(); d++) {
+				opposite[d] = -opposite[d];
+			}
+			positions.push_back( opposite );
+		}
+
+		const Fitnesses fitnesses = evaluateFunction( positions );
+		mNumEvaluations += fitnesses.size();
+		countFailedEvaluations( fitnesses );
+
+		// Keep the best half. Failed evaluations rank last.
+		std::vector< std::pair<Fitness, size_t> > ranked;
+		for (size_t k = 0; k < fitnesses.size(); k++) {
+			const Fitness fitness = ( isFailedFitness(fitnesses[k]) ? WorstPossibleFitness() : fitnesses[k] );
+			ranked.push_back( std::make_pair(fitness, k) );
+		}
+		std::partial_sort( ranked.begin(), ranked.begin() + np, ranked.end() );
+
+		for (size_t i = 0; i < np; i++) {
+			const size_t k = ranked[i].second;
+			mParticles[i]->replaceState( Particle::State(positions[k], mParticles[i]->current().velocity, ranked[i].first) );
+		}
+
+		updateBestSoFar();
+	}
+
+	void Manager::setInitializer(Initializer* initializer) {
+		delete mInitializer;
+		mInitializer = initializer;
+
+		const size_t np = numParticles();
+		destroyParticles();
+		createParticles(np);
+	}
+
+	void Manager::enableOppositionBasedInitialization() {
+		mIsEnabledOppositionBasedInitialization = true;
+	}
+
+	void Manager::disableOppositionBasedInitialization() {
+		mIsEnabledOppositionBasedInitialization = false;
+	}
+
+	bool Manager::isEnabledOppositionBasedInitialization() const {
+		return mIsEnabledOppositionBasedInitialization;
 	}
 
 	void Manager::destroyParticles() {
@@ -90,6 +324,7 @@ namespace ParticleSwarmOptimization {
 			delete mParticles.back();
 			mParticles.pop_back();
 		}
+		mHealthPreviousBests.clear();
 	}
 
 	void Manager::resetParticles() {
@@ -103,7 +338,55 @@ namespace ParticleSwarmOptimization {
 		// Reset the iteration counter
 		mIterationCount = 0;
 
-		resetParticles();
+		mNumEvaluations = 0;
+		mNumFailedEvaluations = 0;
+		mNumDeltaEvaluations = 0;
+		mNumReevaluations = 0;
+		mNumSkippedEvaluations = 0;
+		mNumRestarts = 0;
+		mBestPosition.clear();
+		mBestFitness = WorstPossibleFitness();
+		mEvaluationsToTarget = 0;
+		if (mRestart != 0) {
+			mRestart->reset();
+		}
+
+		destroyParticles();
+		createParticles(mInitialNumParticles);
+
+		mStopReason = NotStopped;
+		publishSnapshot();
+	}
+
+	void Manager::restart(const size_t numParticles) {
+		destroyParticles();
+		createParticles(numParticles);
+		mNumRestarts++;
+	}
+
+	size_t Manager::numRestarts() const {
+		return mNumRestarts;
+	}
+
+	void Manager::setRestartStrategy(RestartStrategy* strategy) {
+		delete mRestart;
+		mRestart = strategy;
+	}
+
+	void Manager::setEvaluationBudget(const size_t budget) {
+		mEvaluationBudget = budget;
+	}
+
+	size_t Manager::evaluationBudget() const {
+		return mEvaluationBudget;
+	}
+
+	size_t Manager::numEvaluations() const {
+		return mNumEvaluations;
+	}
+
+	size_t Manager::numFailedEvaluations() const {
+		return mNumFailedEvaluations;
 	}
 
 	void Manager::loadStandardWeights() {
@@ -119,19 +402,141 @@ namespace ParticleSwarmOptimization {
 	}
 
 	void Manager::estimate () {
+		beginRun();
 		while ( keepLooping() ) {
 			iterate ();
 		}
 	}
 
+	void Manager::beginRun () {
+		mRunStart = monotonicSeconds();
+		mStopReason = NotStopped;
+		publishSnapshot();
+	}
+
+	void Manager::setTimeBudget(const double seconds) {
+		mTimeBudget = seconds;
+	}
+
+	double Manager::timeBudget() const {
+		return mTimeBudget;
+	}
+
+	void Manager::setCancellationToken(const CancellationToken* token) {
+		mCancellationToken = token;
+	}
+
+	RunDiagnostics Manager::diagnostics() const {
+		RunDiagnostics d;
+		d.reason = mStopReason;
+		d.iterations = mIterationCount;
+		d.evaluations = mNumEvaluations;
+		d.failedEvaluations = mNumFailedEvaluations;
+		d.skippedEvaluations = mNumSkippedEvaluations;
+		d.restarts = mNumRestarts;
+		d.elapsedSeconds = ( (mStopReason == NotStopped) ? monotonicSeconds() : mRunStop ) - mRunStart;
+		return d;
+	}
+
+	Snapshot Manager::snapshot() const {
+		ScopedLock lock(*mSnapshotMutex);
+		return mSnapshot;
+	}
+
+	void Manager::publishSnapshot () {
+		const Fitness fitness = getFitness();
+
+		ScopedLock lock(*mSnapshotMutex);
+		if ( (fitness != mSnapshot.fitness) || mSnapshot.position.empty() ) {
+			mSnapshot.position = getEstimate();
+			mSnapshot.fitness = fitness;
+		}
+		mSnapshot.iteration = mIterationCount;
+		mSnapshot.evaluations = mNumEvaluations;
+	}
+
+	void Manager::setHealthMonitor(HealthMonitor* monitor) {
+		mHealthMonitor = monitor;
+		mHealthPreviousBests.clear();
+	}
+
+	void Manager::publishHealth () {
+		if (mHealthMonitor == 0) {
+			return;
+		}
+
+		const size_t np = numParticles();
+		const size_t nd = numDimensions();
+		if (mHealthPreviousBests.size() != np) {
+			// A new swarm: every evaluated particle counts as improved
+			mHealthPreviousBests.assign( np, WorstPossibleFitness() );
+		}
+
+		SwarmHealth& h = mHealth;
+		h.iteration = mIterationCount;
+		h.evaluations = mNumEvaluations;
+		h.elapsedSeconds = monotonicSeconds() - mRunStart;
+		h.bestFitness = getFitness();
+		h.numParticles = np;
+		h.mean.assign( nd, 0.0 );
+		h.variance.assign( nd, 0.0 );
+
+		// One pass: Welford's update per dimension for the positions, sums
+		// for the rest. h.variance holds the sums of squared deviations
+		// until the end.
+		double speeds = 0;
+		size_t clamped = 0;
+		size_t improved = 0;
+		for (size_t i = 0; i < np; i++) {
+			const Particle& p = *mParticles[i];
+			const Position& x = p.current().position;
+			const Velocity& v = p.current().velocity;
+
+			double speed = 0;
+			for (size_t d = 0; d < x.size(); d++) {
+				const double delta = x[d] - h.mean[d];
+				h.mean[d] += delta / (i + 1);
+				h.variance[d] += delta * (x[d] - h.mean[d]);
+				speed += static_cast<double>(v[d]) * v[d];
+			}
+			speeds += std::sqrt( speed );
+			clamped += p.numClampedComponents();
+
+			if (p.best().fitness < mHealthPreviousBests[i]) {
+				improved++;
+			}
+			mHealthPreviousBests[i] = p.best().fitness;
+		}
+
+		double spread = 0;
+		for (size_t d = 0; d < nd; d++) {
+			h.variance[d] = (np > 0 ? h.variance[d] / np : 0.0);
+			spread += h.variance[d];
+		}
+		h.radius = std::sqrt( spread );
+		h.meanSpeed = (np > 0 ? speeds / np : 0.0);
+		h.clampedFraction = (np * nd > 0 ? static_cast<double>(clamped) / (np * nd) : 0.0);
+		h.improvementRate = (np > 0 ? static_cast<double>(improved) / np : 0.0);
+
+		mHealthMonitor->publish( h );
+	}
+
 	Position Manager::getEstimate() const {
+		return bestSoFarPosition();
+	}
+
+	Position Manager::bestSoFarPosition () const {
 		const Particle* p = *std::min_element(mParticles.begin(), mParticles.end(), ParticleBestFitnessCmpp());
+		if (mBestFitness < p->best().fitness) {
+			// Found by a swarm that has since been restarted
+			return mBestPosition;
+		}
 		return p->best().position;
 	}
 
 	Fitness Manager::getFitness() const {
 		const Particle* p = *std::min_element(mParticles.begin(), mParticles.end(), ParticleBestFitnessCmpp());
-		return p->best().fitness;
+		return std::min(mBestFitness, p->best().fitness);
 	}
 
 
@@ -148,8 +553,10 @@ namespace ParticleSwarmOptimization {
 	}
 
 	void Manager::iterate () {
+		prepareParticles();
+
 		// Update the topology
-		mTopology->update();
+		updateTopology();
 		
 		// iterate each particle
 		std::for_each(mParticles.begin(), mParticles.end(), std::mem_fun(&Particle::iterate));
@@ -157,30 +564,446 @@ namespace ParticleSwarmOptimization {
 		// Update each particle's fitness
 		updateParticleFitnesses();
 
+		finishIteration();
+	}
+
+	void Manager::updateTopology () {
+		mTopology->update();
+	}
+
+	void Manager::moveParticle (const ParticleId pid) {
+		mParticles[pid]->iterate();
+	}
+
+	void Manager::finishIteration () {
 		mIterationCount++;
+
+		if ( hasLocalSearch() && (mIterationCount % mLocalSearchInterval == 0) ) {
+			refineBest();
+		}
+
+		publishSnapshot();
+		publishHealth();
+
+		if ( (mRestart != 0) && keepLooping() && mRestart->shouldRestart(*this) ) {
+			restart( mRestart->restartPopulation(numParticles()) );
+		}
 	}
 
 	bool Manager::keepLooping() {
-		return (mIterationCount < mNumIterations);
+		if (mIterationCount >= mNumIterations) {
+			mStopReason = MaxIterationsReached;
+		} else if ( (mEvaluationBudget != 0) && (mNumEvaluations + pendingEvaluations() + preparationEvaluations() + evaluationsPerIteration() > mEvaluationBudget) ) {
+			// Not enough budget left for a full iteration, including the
+			// preparation of a new swarm
+			mStopReason = EvaluationBudgetExhausted;
+		} else if ( (mTimeBudget > 0) && (monotonicSeconds() - mRunStart >= mTimeBudget) ) {
+			mStopReason = TimeBudgetExhausted;
+		} else if ( (mCancellationToken != 0) && mCancellationToken->isCancelled() ) {
+			mStopReason = Cancelled;
+		} else {
+			mStopReason = NotStopped;
+			return true;
+		}
+
+		mRunStop = monotonicSeconds();
+		return false;
+	}
+
+	size_t Manager::evaluationsPerIteration() const {
+		return numParticles() + (mIsEnabledNoisyEvaluation ? mReevaluationsPerIteration : 0);
+	}
+
+	size_t Manager::pendingEvaluations() const {
+		return 0;
 	}
 
 	size_t Manager::iteration() const {
 		return mIterationCount;
 	}
 
+	void Manager::setTopology(Topology* topology) {
+		delete mTopology;
+		mTopology = topology;
+	}
+
+	void Manager::immigrate(const Position& position, const Fitness fitness) {
+		std::vector<Particle*>::iterator worst = std::max_element(mParticles.begin(), mParticles.end(), ParticleBestFitnessCmpp());
+		if (fitness < (*worst)->best().fitness) {
+			(*worst)->replaceState( Particle::State(position, randomVelocity(), fitness) );
+		}
+	}
+
 	void Manager::updateParticleFitnesses () {
+		if (mIsEnabledNoisyEvaluation) {
+			updateParticleFitnessesNoisy();
+			updateBestSoFar();
+			return;
+		}
+
+		if (mIsEnabledDeltaEvaluation) {
+			updateParticleFitnessesDelta();
+			updateBestSoFar();
+			return;
+		}
+
+		if (mIsEnabledLazyEvaluation) {
+			updateParticleFitnessesLazy();
+			updateBestSoFar();
+			return;
+		}
+
+		// Call evaluate function for each particle's position, save the fitness
+		Fitnesses fitnesses = evaluateCurrentPositions();
+
+		// Update the particle's new fitness value
+		assignFitnesses( 0, fitnesses );
+
+		updateBestSoFar();
+	}
+
+	Fitnesses Manager::evaluateCurrentPositions () {
 		Positions positions;
 		for (int i = 0; i < mParticles.size(); i++) {
 			positions.push_back( mParticles[i]->current().position );
 		}
 
-		// Call evaluate function for each particle's position, save the fitness
-		Fitnesses fitnesses = evaluateFunction( positions );
+		return evaluateFunction( positions );
+	}
 
-		// Update the particle's new fitness value
-		for (int i = 0; i < fitnesses.size(); i++) {
-			mParticles[i]->updateFitness( fitnesses[i] );
+	void Manager::updateParticleFitnessesDelta () {
+		// Particles with a known previous fitness are updated incrementally
+		std::vector<ParticleId> deltaIds;
+		std::vector<ParticleId> fullIds;
+		DeltaEvaluations deltas;
+		for (size_t i = 0; i < mParticles.size(); i++) {
+			const Particle* p = mParticles[i];
+			if (p->hasPreviousFitness()) {
+				DeltaEvaluation delta;
+				delta.position = &p->current().position;
+				delta.previousFitness = p->previousFitness();
+				delta.changedDimensions = &p->changedDimensions();
+				delta.previousValues = &p->previousValues();
+				deltas.push_back( delta );
+				deltaIds.push_back( i );
+			} else {
+				fullIds.push_back( i );
+			}
 		}
+
+		Fitnesses fitnesses;
+		if ( !deltas.empty() && evaluateFunctionDelta(deltas, fitnesses) ) {
+			for (size_t k = 0; k < deltaIds.size(); k++) {
+				mParticles[ deltaIds[k] ]->updateFitness( fitnesses.at(k) );
+			}
+			mNumEvaluations += deltaIds.size();
+			mNumDeltaEvaluations += deltaIds.size();
+			countFailedEvaluations( fitnesses );
+		} else {
+			fullIds.insert( fullIds.end(), deltaIds.begin(), deltaIds.end() );
+		}
+
+		if (!fullIds.empty()) {
+			Positions positions;
+			for (size_t k = 0; k < fullIds.size(); k++) {
+				positions.push_back( mParticles[ fullIds[k] ]->current().position );
+			}
+			fitnesses = evaluateFunction( positions );
+			for (size_t k = 0; k < fullIds.size(); k++) {
+				mParticles[ fullIds[k] ]->updateFitness( fitnesses.at(k) );
+			}
+			mNumEvaluations += fullIds.size();
+			countFailedEvaluations( fitnesses );
+		}
+	}
+
+	void Manager::updateParticleFitnessesLazy () {
+		// Particles that barely moved keep their fitness, the others are
+		// evaluated in one batch
+		std::vector<ParticleId> ids;
+		Positions positions;
+		for (size_t i = 0; i < mParticles.size(); i++) {
+			Particle* p = mParticles[i];
+			if ( p->hasPreviousFitness() && (p->displacementSinceEvaluation() < mLazyEvaluationTolerance) ) {
+				p->keepFitness();
+				mNumSkippedEvaluations++;
+			} else {
+				ids.push_back( i );
+				positions.push_back( p->current().position );
+			}
+		}
+
+		if (!positions.empty()) {
+			const Fitnesses fitnesses = evaluateFunction( positions );
+			for (size_t k = 0; k < ids.size(); k++) {
+				mParticles[ ids[k] ]->updateFitness( fitnesses.at(k) );
+			}
+			mNumEvaluations += ids.size();
+			countFailedEvaluations( fitnesses );
+		}
+	}
+
+	void Manager::updateParticleFitnessesNoisy () {
+		const size_t np = mParticles.size();
+		const std::vector<ParticleId> reevaluations = selectReevaluations( mReevaluationsPerIteration );
+
+		// New positions followed by the best positions to sample again
+		Positions positions;
+		positions.reserve( np + reevaluations.size() );
+		for (size_t i = 0; i < np; i++) {
+			positions.push_back( mParticles[i]->current().position );
+		}
+		for (size_t k = 0; k < reevaluations.size(); k++) {
+			positions.push_back( mParticles[ reevaluations[k] ]->best().position );
+		}
+
+		const Fitnesses fitnesses = evaluateFunction( positions );
+
+		// The samples refer to the bests before this iteration's moves
+		const Fitnesses samples( fitnesses.begin() + np, fitnesses.end() );
+		for (size_t k = 0; k < reevaluations.size(); k++) {
+			mParticles[ reevaluations[k] ]->addBestSample( samples.at(k) );
+		}
+		mNumEvaluations += samples.size();
+		mNumReevaluations += samples.size();
+		countFailedEvaluations( samples );
+
+		assignFitnesses( 0, Fitnesses(fitnesses.begin(), fitnesses.begin() + np) );
+	}
+
+	std::vector<ParticleId> Manager::selectReevaluations (const size_t count) const {
+		// The evaluated best states are the designs
+		std::vector<ParticleId> ids;
+		for (size_t i = 0; i < mParticles.size(); i++) {
+			if (mParticles[i]->bestNumSamples() > 0) {
+				ids.push_back( i );
+			}
+		}
+
+		std::vector<ParticleId> selected;
+		if ( ids.empty() || (count == 0) ) {
+			return selected;
+		}
+
+		// Pool the variances of the states sampled at least twice, and use it
+		// for the others
+		Fitness pooled = 0;
+		size_t numPooled = 0;
+		size_t totalSamples = 0;
+		for (size_t k = 0; k < ids.size(); k++) {
+			const Particle* p = mParticles[ ids[k] ];
+			if (p->bestNumSamples() > 1) {
+				pooled += p->bestVariance();
+				numPooled++;
+			}
+			totalSamples += p->bestNumSamples();
+		}
+
+		std::vector<double> weights( ids.size(), 1.0 );
+		if ( (numPooled > 0) && (pooled > 0) && (ids.size() > 1) ) {
+			pooled /= numPooled;
+
+			// Variances and gaps in units of the pooled noise, with floors that
+			// keep the weights finite when states have no spread or tie with
+			// the best
+			std::vector<double> variances( ids.size() );
+			size_t best = 0;
+			for (size_t k = 0; k < ids.size(); k++) {
+				const Particle* p = mParticles[ ids[k] ];
+				variances[k] = std::max( (p->bestNumSamples() > 1 ? p->bestVariance() : pooled) / pooled, 1e-12 );
+				if (p->best().fitness < mParticles[ ids[best] ]->best().fitness) {
+					best = k;
+				}
+			}
+
+			// N_i / N_j = (s_i / d_i)^2 / (s_j / d_j)^2 for i, j != b,
+			// and N_b = s_b * sqrt( sum_i N_i^2 / s_i^2 )
+			const Fitness bestMean = mParticles[ ids[best] ]->best().fitness;
+			const double noise = std::sqrt(pooled);
+			double sumSquares = 0;
+			for (size_t k = 0; k < ids.size(); k++) {
+				if (k != best) {
+					const double gap = std::max( (mParticles[ ids[k] ]->best().fitness - bestMean) / noise, 1e-6 );
+					weights[k] = variances[k] / (gap * gap);
+					sumSquares += weights[k] * weights[k] / variances[k];
+				}
+			}
+			weights[best] = std::sqrt( variances[best] * sumSquares );
+		}
+		// Without any variance estimate, spread the samples evenly
+
+		double totalWeight = 0;
+		for (size_t k = 0; k < weights.size(); k++) {
+			totalWeight += weights[k];
+		}
+
+		// Give every sample to the state furthest below its target share
+		const double budget = static_cast<double>( totalSamples + count );
+		std::vector<size_t> allocated( ids.size(), 0 );
+		for (size_t s = 0; s < count; s++) {
+			size_t neediest = 0;
+			double largestDeficit = -std::numeric_limits<double>::max();
+			for (size_t k = 0; k < ids.size(); k++) {
+				const double target = budget * weights[k] / totalWeight;
+				const double deficit = target - (mParticles[ ids[k] ]->bestNumSamples() + allocated[k]);
+				if (deficit > largestDeficit) {
+					largestDeficit = deficit;
+					neediest = k;
+				}
+			}
+			allocated[neediest]++;
+			selected.push_back( ids[neediest] );
+		}
+		return selected;
+	}
+
+	void Manager::enableNoisyEvaluation(const size_t reevaluationsPerIteration) {
+		mIsEnabledNoisyEvaluation = true;
+		mReevaluationsPerIteration = reevaluationsPerIteration;
+	}
+
+	void Manager::disableNoisyEvaluation() {
+		mIsEnabledNoisyEvaluation = false;
+	}
+
+	bool Manager::isEnabledNoisyEvaluation() const {
+		return mIsEnabledNoisyEvaluation;
+	}
+
+	size_t Manager::numReevaluations() const {
+		return mNumReevaluations;
+	}
+
+	bool Manager::evaluateFunctionDelta (const DeltaEvaluations& /*deltas*/, Fitnesses& /*fitnesses*/) {
+		return false;
+	}
+
+	void Manager::enableDeltaEvaluation() {
+		mIsEnabledDeltaEvaluation = true;
+	}
+
+	void Manager::disableDeltaEvaluation() {
+		mIsEnabledDeltaEvaluation = false;
+	}
+
+	bool Manager::isEnabledDeltaEvaluation() const {
+		return mIsEnabledDeltaEvaluation;
+	}
+
+	size_t Manager::numDeltaEvaluations() const {
+		return mNumDeltaEvaluations;
+	}
+
+	void Manager::enableLazyEvaluation(const double tolerance) {
+		mIsEnabledLazyEvaluation = true;
+		mLazyEvaluationTolerance = tolerance;
+	}
+
+	void Manager::disableLazyEvaluation() {
+		mIsEnabledLazyEvaluation = false;
+	}
+
+	bool Manager::isEnabledLazyEvaluation() const {
+		return mIsEnabledLazyEvaluation;
+	}
+
+	size_t Manager::numSkippedEvaluations() const {
+		return mNumSkippedEvaluations;
+	}
+
+	bool Manager::acceptAsBest (const Particle& particle) {
+		return (particle.current().fitness < particle.best().fitness);
+	}
+
+	void Manager::assignFitnesses (const ParticleId first, const Fitnesses& fitnesses) {
+		for (size_t i = 0; i < fitnesses.size(); i++) {
+			mParticles[first + i]->updateFitness( fitnesses[i] );
+		}
+		mNumEvaluations += fitnesses.size();
+		countFailedEvaluations( fitnesses );
+	}
+
+	void Manager::countFailedEvaluations (const Fitnesses& fitnesses) {
+		for (size_t i = 0; i < fitnesses.size(); i++) {
+			if (isFailedFitness(fitnesses[i])) {
+				mNumFailedEvaluations++;
+			}
+		}
+	}
+
+	void Manager::updateBestSoFar() {
+		const Particle* p = *std::min_element(mParticles.begin(), mParticles.end(), ParticleBestFitnessCmpp());
+		if ( mIsEnabledNoisyEvaluation && (p->best().fitness != WorstPossibleFitness()) ) {
+			// Means change as samples arrive, an old minimum may have been luck
+			mBestPosition = p->best().position;
+			mBestFitness = p->best().fitness;
+		} else if (p->best().fitness < mBestFitness) {
+			mBestPosition = p->best().position;
+			mBestFitness = p->best().fitness;
+		}
+
+		if ( mHasTarget && (mEvaluationsToTarget == 0) && (mBestFitness <= mTargetFitness) ) {
+			mEvaluationsToTarget = mNumEvaluations;
+		}
+	}
+
+	void Manager::restoreProgress (const size_t iteration, const size_t evaluations) {
+		mIterationCount = iteration;
+		mNumEvaluations = evaluations;
+	}
+
+	void Manager::restoreParticle (const ParticleId pid, const Position& position, const Fitness fitness) {
+		mParticles.at(pid)->replaceState( Particle::State(position, randomVelocity(), fitness) );
+	}
+
+	void Manager::restoreBestSoFar (const Position& position, const Fitness fitness) {
+		mBestPosition = position;
+		mBestFitness = fitness;
+	}
+
+	void Manager::setLocalSearch(LocalSearch* search, const size_t interval, const size_t evaluationsPerRefinement) {
+		delete mLocalSearch;
+		mLocalSearch = search;
+		mLocalSearchInterval = interval;
+		mLocalSearchEvaluations = evaluationsPerRefinement;
+	}
+
+	bool Manager::hasLocalSearch() const {
+		return (mLocalSearch != 0) && (mLocalSearchInterval != 0);
+	}
+
+	void Manager::refineBest() {
+		size_t evaluations = mLocalSearchEvaluations;
+		if (mEvaluationBudget != 0) {
+			const size_t remaining = (mNumEvaluations < mEvaluationBudget ? mEvaluationBudget - mNumEvaluations : 0);
+			evaluations = std::min(evaluations, remaining);
+		}
+		if (evaluations == 0) {
+			return;
+		}
+
+		Particle* p = *std::min_element(mParticles.begin(), mParticles.end(), ParticleBestFitnessCmpp());
+		Position position = p->best().position;
+		Fitness fitness = p->best().fitness;
+
+		RefinementEvaluator evaluator(this);
+		mLocalSearch->refine( position, fitness, evaluator, evaluations );
+
+		p->improveBest( position, fitness );
+		updateBestSoFar();
+	}
+
+	void Manager::setTargetFitness(const Fitness target) {
+		mHasTarget = true;
+		mTargetFitness = target;
+	}
+
+	bool Manager::hasReachedTarget() const {
+		return (mEvaluationsToTarget != 0);
+	}
+
+	size_t Manager::evaluationsToTarget() const {
+		return mEvaluationsToTarget;
 	}
 
 	size_t Manager::numDimensions () const {
@@ -193,10 +1016,18 @@ namespace ParticleSwarmOptimization {
 		return mTopology->socialBest( asker );
 	}
 
+	ParticleId Manager::socialBestId (const Particle& asker) {
+		const ParticleId pid = mTopology->socialBestId( asker );
+		if (pid == Topology::NoParticleId) {
+			throw std::logic_error("Manager: the topology does not provide socialBestId()");
+		}
+		return pid;
+	}
+
 	Position Manager::randomPosition() {
 		Position pos( numDimensions() );
 		for (size_t d = 0; d < pos.size(); d++) {
-			pos[d] = uniform();
+			pos[d] = static_cast<VecCom>( uniform() );
 		}
 		return pos;
 	}
@@ -204,7 +1035,7 @@ namespace ParticleSwarmOptimization {
 	Velocity Manager::randomVelocity() {
 		Velocity vel( numDimensions() );
 		for (size_t d = 0; d < vel.size(); d++) {
-			vel[d] = uniform();
+			vel[d] = static_cast<VecCom>( uniform() );
 		}
 		return vel;
 	}
@@ -15,12 +15,98 @@ namespace ParticleSwarmOptimization {
 	// Returns the "worst possible" fitness, which is the maximum Fitness value possible
 	Fitness WorstPossibleFitness();
 
+	// Marks an evaluation that failed or timed out (a quiet NaN). It never
+	// becomes a particle's best and is counted apart from poor fitnesses.
+	Fitness FailedFitness();
+	bool isFailedFitness(const Fitness fitness);
+
 	class Particle;
 	class Topology;
 	class InertiaScaling;
+	class RestartStrategy;
+	class Initializer;
+	class LocalSearch;
+	class IslandModel;
+	class Mutex;
+	class CancellationToken;
+	class HealthMonitor;
+
+	// Why the last run stopped
+	enum StopReason {
+		NotStopped,
+		MaxIterationsReached,
+		EvaluationBudgetExhausted,
+		TimeBudgetExhausted,
+		Cancelled
+	};
+
+	// Summary of the last run, see Manager::diagnostics()
+	struct RunDiagnostics {
+		RunDiagnostics ()
+		: reason(NotStopped), iterations(0), evaluations(0), failedEvaluations(0), skippedEvaluations(0), restarts(0),
+		  elapsedSeconds(0) {}
+
+		StopReason reason;
+		size_t iterations;
+		size_t evaluations;
+		size_t failedEvaluations;
+		size_t skippedEvaluations;
+		size_t restarts;
+		double elapsedSeconds;
+	};
+
+	// Consistent copy of the best result, safe to take from any thread
+	struct Snapshot {
+		Snapshot ()
+		: fitness(WorstPossibleFitness()), iteration(0), evaluations(0) {}
+
+		Position position;
+		Fitness fitness;
+		size_t iteration;
+		size_t evaluations;
+	};
+
+	// State of the swarm after one iteration, see Manager::setHealthMonitor().
+	// The spatial metrics are over the current positions and velocities.
+	struct SwarmHealth {
+		SwarmHealth ()
+		: iteration(0), evaluations(0), elapsedSeconds(0), bestFitness(WorstPossibleFitness()), numParticles(0),
+		  radius(0), meanSpeed(0), clampedFraction(0), improvementRate(0) {}
+
+		size_t iteration;
+		size_t evaluations;
+		double elapsedSeconds;
+		Fitness bestFitness;
+		size_t numParticles;
+
+		// Per dimension mean and (population) variance of the positions
+		std::vector<double> mean;
+		std::vector<double> variance;
+
+		// Root mean square distance of the particles to their centroid
+		double radius;
+		// Mean Euclidean norm of the velocities
+		double meanSpeed;
+		// Fraction of velocity components limited by the maximum speed
+		double clampedFraction;
+		// Fraction of particles whose personal best improved
+		double improvementRate;
+	};
+
+	// Incremental evaluation request for one particle, see
+	// Manager::evaluateFunctionDelta(). The previous position is the current
+	// one with previousValues written back at changedDimensions.
+	struct DeltaEvaluation {
+		const Position* position;
+		Fitness previousFitness;
+		const std::vector<size_t>* changedDimensions;
+		const std::vector<VecCom>* previousValues;
+	};
+	typedef std::vector<DeltaEvaluation> DeltaEvaluations;
 
 	class Manager {
 		friend class Particle;
+		friend class IslandModel;
 
 	public:
 		// Standard PSO
@@ -51,10 +137,118 @@ namespace ParticleSwarmOptimization {
 		void disableMaxSpeedPerDimension();
 		bool isEnabledMaxSpeedPerDimension() const;
 
-		void reset();
+		// Lets evaluateFunctionDelta() update fitnesses incrementally
+		void enableDeltaEvaluation();
+		void disableDeltaEvaluation();
+		bool isEnabledDeltaEvaluation() const;
+
+		// Generates the initial particle positions, e.g. a low-discrepancy
+		// sequence. The manager takes ownership and recreates the particles.
+		// Pass 0 to return to independent uniform draws.
+		void setInitializer(Initializer* initializer);
+
+		// Before the first iteration of a new swarm, evaluates every initial
+		// position together with its opposite in one batch and keeps the
+		// better half. Costs two evaluations per particle.
+		void enableOppositionBasedInitialization();
+		void disableOppositionBasedInitialization();
+		bool isEnabledOppositionBasedInitialization() const;
+
+		// For noisy objectives: the best fitness of a particle is the mean of
+		// all samples of its best position, and every iteration the given
+		// number of best positions chosen by selectReevaluations() are
+		// evaluated again, in the same batch as the particles' new positions.
+		// The best so far then follows the swarm's current best mean.
+		void enableNoisyEvaluation(const size_t reevaluationsPerIteration);
+		void disableNoisyEvaluation();
+		bool isEnabledNoisyEvaluation() const;
+
+		// Number of re-evaluations of best positions. These are also included
+		// in numEvaluations().
+		size_t numReevaluations() const;
+
+		// Skips the evaluation of particles that moved less than the
+		// tolerance (Euclidean path length) since they were last evaluated;
+		// they keep their previous fitness. Ignored while delta or noisy
+		// evaluation is enabled.
+		void enableLazyEvaluation(const double tolerance);
+		void disableLazyEvaluation();
+		bool isEnabledLazyEvaluation() const;
+
+		// Evaluations avoided by lazy evaluation. These are not included in
+		// numEvaluations().
+		size_t numSkippedEvaluations() const;
+
+		// Number of evaluations done through evaluateFunctionDelta(). These
+		// are also included in numEvaluations().
+		size_t numDeltaEvaluations() const;
+
+		virtual void reset();
 
 		size_t iteration() const;
 
+		// Replaces the communication topology. The manager takes ownership.
+		void setTopology(Topology* topology);
+
+		// Replaces the particle with the worst personal best by the given
+		// state, if the immigrant is better. Used for migration between swarms.
+		// Override when the particles do not hold their positions.
+		virtual void immigrate(const Position& position, const Fitness fitness);
+
+		// Limits the total number of function evaluations, including those
+		// spent in restarts. Zero means no limit.
+		void setEvaluationBudget(const size_t budget);
+		size_t evaluationBudget() const;
+		size_t numEvaluations() const;
+
+		// Evaluations that returned FailedFitness(). These are also included
+		// in numEvaluations().
+		size_t numFailedEvaluations() const;
+
+		// Restarts the swarm automatically when the strategy asks for it.
+		// The manager takes ownership. Pass 0 to disable restarts.
+		void setRestartStrategy(RestartStrategy* strategy);
+
+		// Recreates the swarm with the given number of particles, keeping the
+		// iteration count, evaluation count and best-so-far result
+		virtual void restart(const size_t numParticles);
+		size_t numRestarts() const;
+
+		// Every interval iterations, hands the best particle's best position to
+		// the local search, which may spend up to evaluationsPerRefinement
+		// evaluations (within the evaluation budget). Improvements become the
+		// particle's new best. The manager takes ownership. Pass 0 to disable.
+		void setLocalSearch(LocalSearch* search, const size_t interval, const size_t evaluationsPerRefinement);
+		bool hasLocalSearch() const;
+
+		// Records when the best-so-far fitness first reaches the target
+		void setTargetFitness(const Fitness target);
+		bool hasReachedTarget() const;
+		// Number of evaluations spent when the target was reached
+		size_t evaluationsToTarget() const;
+
+		// Stops a run cleanly between iterations once the given wall-clock
+		// time has elapsed since the start of estimate(). Zero means no limit.
+		void setTimeBudget(const double seconds);
+		double timeBudget() const;
+
+		// Stops a run between iterations once the token is cancelled.
+		// The token is not owned. Pass 0 to detach it.
+		void setCancellationToken(const CancellationToken* token);
+
+		// Describes how the last run ended
+		RunDiagnostics diagnostics() const;
+
+		// Best result so far. May be called from another thread while
+		// estimate() is running.
+		Snapshot snapshot() const;
+
+		// Publishes a SwarmHealth to the monitor at the end of every
+		// iteration, from the thread running estimate(). The metrics are
+		// gathered in one pass over the particles. The monitor is not owned.
+		// Pass 0 to detach it.
+		void setHealthMonitor(HealthMonitor* monitor);
+
 	protected:
 		void resetParticles();
 
@@ -62,17 +256,85 @@ namespace ParticleSwarmOptimization {
 
 		bool keepLooping();
 
+		// Evaluations spent by one iteration
+		size_t evaluationsPerIteration() const;
+
+		// Evaluations already submitted but not yet counted, which the
+		// evaluation budget must still cover. The default has none.
+		virtual size_t pendingEvaluations() const;
+
 		
 		// This should evaluate a fitness function, e.g. z = f(x,y)
 		virtual Fitnesses evaluateFunction (const Positions& positions ) = 0;
 
+		// Evaluates the current positions of all particles, in particle
+		// order. The default collects them and calls evaluateFunction().
+		// Override to hand the positions to an evaluator in another layout
+		// without building a Positions.
+		virtual Fitnesses evaluateCurrentPositions ();
+
+		// Optional incremental evaluation, used when delta evaluation is
+		// enabled. Fill fitnesses (one per request) from the previous fitness
+		// and the changed coordinates, and return true. Returning false makes
+		// the manager fall back to evaluateFunction(), which the default does.
+		virtual bool evaluateFunctionDelta (const DeltaEvaluations& deltas, Fitnesses& fitnesses);
+
 		void updateParticleFitnesses ();
+		void updateParticleFitnessesDelta ();
+		void updateParticleFitnessesNoisy ();
+		void updateParticleFitnessesLazy ();
+
+		// Chooses the particles whose best position is evaluated again, one
+		// entry per sample, so a particle may appear several times. The
+		// default follows the optimal computing budget allocation (OCBA) for
+		// selecting the best: samples go to the best states that are close to
+		// the best mean relative to their noise.
+		virtual std::vector<ParticleId> selectReevaluations (const size_t count) const;
+
+		// Decides whether a particle's newly evaluated state becomes its
+		// personal best. The default accepts a strictly lower fitness.
+		virtual bool acceptAsBest (const Particle& particle);
+
+		// Sets the fitnesses of consecutive particles, starting at first
+		void assignFitnesses (const ParticleId first, const Fitnesses& fitnesses);
+
+		void countFailedEvaluations (const Fitnesses& fitnesses);
+
+		void updateBestSoFar ();
+
+		// Restores a checkpointed run: the progress counters and the fitness
+		// and position of a particle's current and best state
+		void restoreProgress (const size_t iteration, const size_t evaluations);
+		void restoreParticle (const ParticleId pid, const Position& position, const Fitness fitness);
+		void restoreBestSoFar (const Position& position, const Fitness fitness);
+
+		// Position of the best result so far, returned by getEstimate().
+		// Override when the particles do not hold their positions.
+		virtual Position bestSoFarPosition () const;
+
+		// The phases of an iteration, for subclasses that reimplement iterate()
+		void updateTopology ();
+		void moveParticle (const ParticleId pid);
+		void finishIteration ();
+
+		// Starts the clock for the time budget
+		void beginRun ();
+
+		// Publishes the best-so-far result for snapshot()
+		void publishSnapshot ();
+
+		// Gathers and publishes the SwarmHealth, if there is a monitor
+		void publishHealth ();
 
 		size_t numDimensions () const;
 
 		// Returns the social best position for the given particle
 		const Position& socialBest (const Particle& asker );
 
+		// Returns the particle whose best position the given particle follows.
+		// Throws std::logic_error if the topology only provides positions.
+		ParticleId socialBestId (const Particle& asker );
+
 		Weight inertiaWeight() const;
 		/*
 		void setInertiaWeight(const Weight newWeight);
@@ -94,9 +356,23 @@ namespace ParticleSwarmOptimization {
 		void createParticles(const size_t numParticles);
 		void destroyParticles();
 
+		// Prepares a newly created swarm. Called at the start of iterate().
+		void prepareParticles();
+		void initializeByOpposition();
+		void evaluateInitialPositions();
+
+		// Evaluations the pending prepareParticles() will spend
+		size_t preparationEvaluations() const;
+
+		// Runs the local search on the best particle
+		void refineBest();
+
 	private:
 		Manager (const Manager&);
 		void operator=(const Manager&);
+
+		class RefinementEvaluator;
+		friend class RefinementEvaluator;
 		
 		size_t mNumDimensions;
 		size_t mNumIterations;
@@ -110,10 +386,58 @@ namespace ParticleSwarmOptimization {
 		double mMaxSpeedPerDimension;
 		bool mIsEnabledMaxSpeedPerDimension;
 
+		bool mIsEnabledDeltaEvaluation;
+		size_t mNumDeltaEvaluations;
+
+		bool mIsEnabledLazyEvaluation;
+		double mLazyEvaluationTolerance;
+		size_t mNumSkippedEvaluations;
+
+		bool mIsEnabledNoisyEvaluation;
+		size_t mReevaluationsPerIteration;
+		size_t mNumReevaluations;
+
+		LocalSearch* mLocalSearch;
+		size_t mLocalSearchInterval;
+		size_t mLocalSearchEvaluations;
+
+		Initializer* mInitializer;
+		bool mIsEnabledOppositionBasedInitialization;
+		bool mIsSwarmPrepared;
+
 		InertiaScaling* mInertia;
 		Topology* mTopology;
 
 		RandomNumberGenerator* mRng;
+
+		size_t mInitialNumParticles;
+		size_t mNumEvaluations;
+		size_t mNumFailedEvaluations;
+		size_t mEvaluationBudget;
+		size_t mNumRestarts;
+		RestartStrategy* mRestart;
+
+		// Best result seen so far, which survives restarts
+		Position mBestPosition;
+		Fitness mBestFitness;
+
+		bool mHasTarget;
+		Fitness mTargetFitness;
+		size_t mEvaluationsToTarget;
+
+		double mTimeBudget;
+		double mRunStart;
+		double mRunStop;
+		const CancellationToken* mCancellationToken;
+		StopReason mStopReason;
+
+		Mutex* mSnapshotMutex;
+		Snapshot mSnapshot;
+
+		HealthMonitor* mHealthMonitor;
+		SwarmHealth mHealth;
+		// Personal best fitnesses at the previous publication
+		Fitnesses mHealthPreviousBests;
 	};
 
 }; // namespace
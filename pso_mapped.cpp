@@ -0,0 +1,390 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pso_mapped.h"
+
+#include "pso_particle.h"
+
+namespace ParticleSwarmOptimization {
+
+	static const char MAGIC[8] = {'P', 'S', 'O', 'S', 'W', 'A', 'R', 'M'};
+	static const unsigned long long VERSION = 1;
+
+	static size_t pageSize () {
+		const long size = sysconf(_SC_PAGESIZE);
+		return (size > 0 ? static_cast<size_t>(size) : 4096);
+	}
+
+	static size_t roundUpToPage (const size_t bytes) {
+		const size_t page = pageSize();
+		return (bytes + page - 1) / page * page;
+	}
+
+	static std::runtime_error systemError (const std::string& what, const std::string& path) {
+		return std::runtime_error("MappedManager: " + what + " " + path + ": " + std::strerror(errno));
+	}
+
+	MappedManager::MappedManager (const gslseed_t seed, const std::string& path, const size_t numDimensions, const size_t numParticles,
+	 const size_t numIterations, const size_t blockSize)
+	: Manager(seed, 0, numParticles, numIterations), mPath(path), mBlockSize(std::max<size_t>(blockSize, 1)),
+	  mNumDimensions(numDimensions), mFile(-1), mData(0), mSize(0), mHeader(0) {
+		try {
+			create(numDimensions, numParticles);
+		} catch (...) {
+			release();
+			throw;
+		}
+		randomizeParticles();
+	}
+
+	MappedManager::MappedManager (const gslseed_t seed, const std::string& path, const size_t numIterations, const size_t blockSize)
+	: Manager(seed, 0, readHeader(path).numParticles, numIterations), mPath(path), mBlockSize(std::max<size_t>(blockSize, 1)),
+	  mNumDimensions(0), mFile(-1), mData(0), mSize(0), mHeader(0) {
+		try {
+			open();
+		} catch (...) {
+			release();
+			throw;
+		}
+		mNumDimensions = mHeader->numDimensions;
+		restoreParticles();
+	}
+
+	MappedManager::~MappedManager () {
+		release();
+	}
+
+	void MappedManager::release () {
+		if (mData != 0) {
+			munmap(mData, mSize);
+			mData = 0;
+			mHeader = 0;
+		}
+		if (mFile >= 0) {
+			close(mFile);
+			mFile = -1;
+		}
+	}
+
+	MappedSwarmHeader MappedManager::readHeader (const std::string& path) {
+		const int file = ::open(path.c_str(), O_RDONLY);
+		if (file < 0) {
+			throw systemError("cannot open", path);
+		}
+
+		MappedSwarmHeader header;
+		const ssize_t n = pread(file, &header, sizeof(header), 0);
+		close(file);
+
+		if ( (n != static_cast<ssize_t>(sizeof(header))) || (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) ) {
+			throw std::runtime_error("MappedManager: not a swarm file " + path);
+		}
+		if (header.version != VERSION) {
+			throw std::runtime_error("MappedManager: unsupported swarm file version " + path);
+		}
+		if (header.componentSize != sizeof(VecCom)) {
+			throw std::runtime_error("MappedManager: swarm file was written with another precision " + path);
+		}
+		return header;
+	}
+
+	void MappedManager::create (const size_t numDimensions, const size_t numParticles) {
+		const size_t matrix = numParticles * numDimensions * sizeof(VecCom);
+
+		MappedSwarmHeader header;
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+		header.version = VERSION;
+		header.componentSize = sizeof(VecCom);
+		header.numDimensions = numDimensions;
+		header.numParticles = numParticles;
+		header.bestFitness = WorstPossibleFitness();
+		header.positionsOffset = roundUpToPage( sizeof(header) );
+		header.velocitiesOffset = header.positionsOffset + roundUpToPage( matrix );
+		header.bestPositionsOffset = header.velocitiesOffset + roundUpToPage( matrix );
+		header.bestFitnessesOffset = header.bestPositionsOffset + roundUpToPage( matrix );
+		header.bestSoFarOffset = header.bestFitnessesOffset + roundUpToPage( numParticles * sizeof(double) );
+		header.fileSize = header.bestSoFarOffset + roundUpToPage( numDimensions * sizeof(VecCom) );
+
+		mFile = ::open(mPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (mFile < 0) {
+			throw systemError("cannot create", mPath);
+		}
+		if (ftruncate(mFile, header.fileSize) != 0) {
+			throw systemError("cannot size", mPath);
+		}
+
+		map(header.fileSize);
+		std::memcpy(mHeader, &header, sizeof(header));
+	}
+
+	void MappedManager::open () {
+		mFile = ::open(mPath.c_str(), O_RDWR);
+		if (mFile < 0) {
+			throw systemError("cannot open", mPath);
+		}
+
+		struct stat status;
+		if (fstat(mFile, &status) != 0) {
+			throw systemError("cannot stat", mPath);
+		}
+		const MappedSwarmHeader header = readHeader(mPath);
+		if (static_cast<unsigned long long>(status.st_size) < header.fileSize) {
+			throw std::runtime_error("MappedManager: truncated swarm file " + mPath);
+		}
+
+		map(header.fileSize);
+	}
+
+	void MappedManager::map (const size_t fileSize) {
+		void* data = mmap(0, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFile, 0);
+		if (data == MAP_FAILED) {
+			throw systemError("cannot map", mPath);
+		}
+		mData = static_cast<char*>(data);
+		mSize = fileSize;
+		mHeader = reinterpret_cast<MappedSwarmHeader*>(mData);
+
+		// Every pass streams through the matrices in order
+		madvise(mData, mSize, MADV_SEQUENTIAL);
+	}
+
+	void MappedManager::sync () {
+		if (msync(mData, mSize, MS_SYNC) != 0) {
+			throw systemError("cannot sync", mPath);
+		}
+	}
+
+	void MappedManager::randomizeParticles () {
+		const size_t np = numParticles();
+		double* fitnesses = bestFitnesses();
+		for (ParticleId pid = 0; pid < np; pid++) {
+			VecCom* x = position(pid);
+			VecCom* v = velocity(pid);
+			for (size_t d = 0; d < mNumDimensions; d++) {
+				x[d] = static_cast<VecCom>( uniform() );
+				v[d] = static_cast<VecCom>( uniform() );
+			}
+			std::memcpy(bestPosition(pid), x, mNumDimensions * sizeof(VecCom));
+			fitnesses[pid] = WorstPossibleFitness();
+		}
+	}
+
+	void MappedManager::restoreParticles () {
+		const double* fitnesses = bestFitnesses();
+		for (ParticleId pid = 0; pid < numParticles(); pid++) {
+			restoreParticle(pid, Position(), fitnesses[pid]);
+		}
+		restoreProgress(mHeader->iteration, mHeader->numEvaluations);
+
+		// The best so far may predate a restart
+		restoreBestSoFar(bestSoFarPosition(), mHeader->bestFitness);
+		updateBestSoFar();
+	}
+
+	void MappedManager::reset () {
+		randomizeParticles();
+		mHeader->iteration = 0;
+		mHeader->numEvaluations = 0;
+		mHeader->bestFitness = WorstPossibleFitness();
+
+		Manager::reset();
+	}
+
+	void MappedManager::restart (const size_t /*numParticles*/) {
+		// The file layout is fixed, keep the population size
+		Manager::restart( this->numParticles() );
+		randomizeParticles();
+	}
+
+	void MappedManager::immigrate (const Position& position, const Fitness fitness) {
+		if (position.size() != mNumDimensions) {
+			throw std::invalid_argument("MappedManager: immigrant has the wrong number of dimensions");
+		}
+
+		double* bests = bestFitnesses();
+		const ParticleId worst = std::max_element(bests, bests + numParticles()) - bests;
+		if ( !(fitness < bests[worst]) ) {
+			return;
+		}
+
+		std::copy(position.begin(), position.end(), this->position(worst));
+		std::copy(position.begin(), position.end(), bestPosition(worst));
+		VecCom* v = velocity(worst);
+		for (size_t d = 0; d < mNumDimensions; d++) {
+			v[d] = static_cast<VecCom>( uniform() );
+		}
+		bests[worst] = fitness;
+		restoreParticle(worst, Position(), fitness);
+
+		if (fitness < mHeader->bestFitness) {
+			mHeader->bestFitness = fitness;
+			std::copy(position.begin(), position.end(), bestSoFar());
+		}
+	}
+
+	void MappedManager::iterate () {
+		if (isEnabledNoisyEvaluation()) {
+			// The re-evaluations need the best positions in memory, and the budget would reserve them anyway
+			throw std::logic_error("MappedManager: noisy evaluation is not available");
+		}
+		if (isEnabledLazyEvaluation()) {
+			// Every block is evaluated as a whole
+			throw std::logic_error("MappedManager: lazy evaluation is not available");
+		}
+		if (isEnabledDeltaEvaluation()) {
+			// Blocks are evaluated with evaluateFunction() only
+			throw std::logic_error("MappedManager: delta evaluation is not available");
+		}
+		if (isEnabledOppositionBasedInitialization()) {
+			// The initial positions are written to the file by the constructor
+			throw std::logic_error("MappedManager: opposition-based initialization is not available");
+		}
+		if (hasLocalSearch()) {
+			// The particles hold no best position to refine
+			throw std::logic_error("MappedManager: the local search is not available");
+		}
+
+		updateTopology();
+
+		const size_t np = numParticles();
+		for (ParticleId first = 0; first < np; first += mBlockSize) {
+			const ParticleId last = std::min(first + mBlockSize, np);
+			prefetch(last, std::min(last + mBlockSize, np));
+			moveBlock(first, last);
+		}
+
+		for (ParticleId first = 0; first < np; first += mBlockSize) {
+			const ParticleId last = std::min(first + mBlockSize, np);
+			prefetch(last, std::min(last + mBlockSize, np));
+			evaluateBlock(first, last);
+		}
+
+		updateBestSoFar();
+
+		finishIteration();
+
+		mHeader->iteration = iteration();
+		mHeader->numEvaluations = numEvaluations();
+	}
+
+	void MappedManager::moveBlock (const ParticleId first, const ParticleId last) {
+		for (ParticleId pid = first; pid < last; pid++) {
+			moveRow(pid);
+		}
+	}
+
+	// Same update as Particle::iterate() on the mapped rows
+	void MappedManager::moveRow (const ParticleId pid) {
+		const VecCom* socialBest = bestPosition( socialBestId(particle(pid)) );
+		const VecCom* best = bestPosition(pid);
+		VecCom* x = position(pid);
+		VecCom* v = velocity(pid);
+
+		const VecCom inertia = static_cast<VecCom>( inertiaWeight() );
+		const VecCom social = static_cast<VecCom>( socialWeight() );
+		const VecCom cognitive = static_cast<VecCom>( cognitiveWeight() );
+		const bool isClamped = isEnabledMaxSpeedPerDimension();
+		const VecCom maxSpeed = static_cast<VecCom>( maxSpeedPerDimension() );
+
+		for (size_t d = 0; d < mNumDimensions; d++) {
+			const VecCom u1 = static_cast<VecCom>( uniform(0, 1) );
+			const VecCom u2 = static_cast<VecCom>( uniform(0, 1) );
+			VecCom speed = inertia * v[d] + social * u1 * (socialBest[d] - x[d]) + cognitive * u2 * (best[d] - x[d]);
+			if (isClamped) {
+				speed = std::max(-maxSpeed, std::min(maxSpeed, speed));
+			}
+			v[d] = speed;
+			x[d] += speed;
+		}
+	}
+
+	void MappedManager::evaluateBlock (const ParticleId first, const ParticleId last) {
+		Positions positions( last - first, Position(mNumDimensions) );
+		for (ParticleId pid = first; pid < last; pid++) {
+			const VecCom* x = position(pid);
+			std::copy(x, x + mNumDimensions, positions[pid - first].begin());
+		}
+
+		Fitnesses fitnesses = evaluateFunction( positions );
+
+		// Like Particle, discard evaluations outside of the search box
+		for (size_t i = 0; i < fitnesses.size(); i++) {
+			if (!isPositionWithinBounds(positions[i])) {
+				fitnesses[i] = WorstPossibleFitness();
+			}
+		}
+
+		assignFitnesses( first, fitnesses );
+
+		double* bests = bestFitnesses();
+		for (ParticleId pid = first; pid < last; pid++) {
+			const Fitness fitness = particle(pid).best().fitness;
+			if (fitness < bests[pid]) {
+				bests[pid] = fitness;
+				std::copy(positions[pid - first].begin(), positions[pid - first].end(), bestPosition(pid));
+
+				if (fitness < mHeader->bestFitness) {
+					mHeader->bestFitness = fitness;
+					std::copy(positions[pid - first].begin(), positions[pid - first].end(), bestSoFar());
+				}
+			}
+		}
+	}
+
+	void MappedManager::prefetch (const ParticleId first, const ParticleId last) const {
+		if (first >= last) {
+			return;
+		}
+
+		const size_t page = pageSize();
+		const size_t bytes = (last - first) * mNumDimensions * sizeof(VecCom);
+		const VecCom* rows[3] = { position(first), velocity(first), bestPosition(first) };
+		for (size_t k = 0; k < 3; k++) {
+			const size_t begin = reinterpret_cast<const char*>(rows[k]) - mData;
+			const size_t alignedBegin = begin / page * page;
+			madvise(mData + alignedBegin, bytes + (begin - alignedBegin), MADV_WILLNEED);
+		}
+	}
+
+	Position MappedManager::bestSoFarPosition () const {
+		const VecCom* best = bestSoFar();
+		return Position(best, best + mNumDimensions);
+	}
+
+	const std::string& MappedManager::path() const {
+		return mPath;
+	}
+
+	size_t MappedManager::blockSize() const {
+		return mBlockSize;
+	}
+
+	VecCom* MappedManager::position (const ParticleId pid) const {
+		return reinterpret_cast<VecCom*>(mData + mHeader->positionsOffset) + pid * mNumDimensions;
+	}
+
+	VecCom* MappedManager::velocity (const ParticleId pid) const {
+		return reinterpret_cast<VecCom*>(mData + mHeader->velocitiesOffset) + pid * mNumDimensions;
+	}
+
+	VecCom* MappedManager::bestPosition (const ParticleId pid) const {
+		return reinterpret_cast<VecCom*>(mData + mHeader->bestPositionsOffset) + pid * mNumDimensions;
+	}
+
+	double* MappedManager::bestFitnesses () const {
+		return reinterpret_cast<double*>(mData + mHeader->bestFitnessesOffset);
+	}
+
+	VecCom* MappedManager::bestSoFar () const {
+		return reinterpret_cast<VecCom*>(mData + mHeader->bestSoFarOffset);
+	}
+
+}; // namespace
@@ -0,0 +1,130 @@
+#ifndef INC_PSO_MAPPED_H
+#define INC_PSO_MAPPED_H
+
+#include <string>
+
+#include "pso_types.h"
+#include "pso_manager.h"
+
+namespace ParticleSwarmOptimization {
+
+	// Layout of a swarm file, see MappedManager. All integers are 64-bit and
+	// everything is in the byte order of the machine that wrote the file.
+	//
+	//   offset 0                 MappedSwarmHeader, padded to one page
+	//   positionsOffset          positions,       numParticles x numDimensions VecCom
+	//   velocitiesOffset         velocities,      numParticles x numDimensions VecCom
+	//   bestPositionsOffset      best positions,  numParticles x numDimensions VecCom
+	//   bestFitnessesOffset      best fitnesses,  numParticles double
+	//   bestSoFarOffset          best position so far, numDimensions VecCom
+	//
+	// The matrices are particle-major: the numDimensions components of a
+	// particle are consecutive. Every section starts on a page boundary.
+	struct MappedSwarmHeader {
+		char magic[8];                      // "PSOSWARM"
+		unsigned long long version;         // 1
+		unsigned long long componentSize;   // sizeof(VecCom)
+		unsigned long long numDimensions;
+		unsigned long long numParticles;
+		unsigned long long iteration;
+		unsigned long long numEvaluations;
+		double bestFitness;                 // fitness of the best position so far
+		unsigned long long positionsOffset;
+		unsigned long long velocitiesOffset;
+		unsigned long long bestPositionsOffset;
+		unsigned long long bestFitnessesOffset;
+		unsigned long long bestSoFarOffset;
+		unsigned long long fileSize;
+	};
+
+	// A Manager whose particle state lives in a memory-mapped file instead of
+	// memory, for swarms larger than RAM. The matrices are streamed in blocks
+	// of blockSize particles: one sequential pass moves the particles, a
+	// second evaluates them, one block per call to evaluateFunction(), with
+	// the next block prefetched.
+	//
+	// The file doubles as a checkpoint. Between iterations it holds a
+	// consistent state; call sync() to make it durable, and reopen it with
+	// the reopening constructor to continue the run.
+	//
+	// The driving loop, budgets, topologies and diagnostics are those of
+	// Manager; the topology must implement socialBestId(). A restart
+	// re-randomizes the particles but keeps their number.
+	// Not every Manager mode applies to the mapped rows:
+	// - noisy, lazy and delta evaluation, opposition-based initialization
+	//   and the local search are not available; estimate() throws
+	//   std::logic_error when one of them is enabled.
+	// - initializers are ignored, the constructor draws the initial swarm.
+	// - the health telemetry reports only the progress and fitness fields
+	//   (iteration, evaluations, elapsedSeconds, bestFitness, numParticles,
+	//   improvementRate). The base particles have no dimensions, so the
+	//   mean and variance are empty and the radius, speed and clamped
+	//   fraction are zero.
+	class MappedManager : public Manager {
+	public:
+		// Creates (or truncates) the file and randomly initializes the swarm
+		MappedManager (const gslseed_t seed, const std::string& path, const size_t numDimensions, const size_t numParticles,
+		 const size_t numIterations, const size_t blockSize = 1024);
+
+		// Reopens a swarm file, continuing at its iteration count
+		MappedManager (const gslseed_t seed, const std::string& path, const size_t numIterations, const size_t blockSize = 1024);
+
+		virtual ~MappedManager ();
+
+		// Flushes the mapping to the file
+		void sync ();
+
+		const std::string& path() const;
+		size_t blockSize() const;
+
+		virtual void reset();
+		virtual void restart(const size_t numParticles);
+
+		// Writes the immigrant over the rows of the worst particle
+		virtual void immigrate(const Position& position, const Fitness fitness);
+
+	protected:
+		virtual void iterate ();
+
+		// Read from the file, the particles hold no positions
+		virtual Position bestSoFarPosition () const;
+
+	private:
+		MappedManager (const MappedManager&);
+		void operator=(const MappedManager&);
+
+		static MappedSwarmHeader readHeader (const std::string& path);
+
+		void create (const size_t numDimensions, const size_t numParticles);
+		void open ();
+		void map (const size_t fileSize);
+		void release ();
+		void randomizeParticles ();
+		void restoreParticles ();
+
+		void moveRow (const ParticleId pid);
+		void moveBlock (const ParticleId first, const ParticleId last);
+		void evaluateBlock (const ParticleId first, const ParticleId last);
+
+		// Hints that the rows [first, last) of every matrix are needed soon
+		void prefetch (const ParticleId first, const ParticleId last) const;
+
+		VecCom* position (const ParticleId pid) const;
+		VecCom* velocity (const ParticleId pid) const;
+		VecCom* bestPosition (const ParticleId pid) const;
+		double* bestFitnesses () const;
+		VecCom* bestSoFar () const;
+
+		std::string mPath;
+		size_t mBlockSize;
+		size_t mNumDimensions;
+
+		int mFile;
+		char* mData;
+		size_t mSize;
+		MappedSwarmHeader* mHeader;
+	};
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_MAPPED_H
@@ -0,0 +1,355 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "pso_multiobjective.h"
+
+#include "pso_particle.h"
+
+#include "pso_topology.h"
+
+namespace ParticleSwarmOptimization {
+
+	static bool hasFailedObjective (const Objectives& objectives) {
+		for (size_t k = 0; k < objectives.size(); k++) {
+			if (isFailedFitness(objectives[k])) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Orders entry indices by one objective
+	class ObjectiveCmp {
+	public:
+		ObjectiveCmp (const std::vector<ParetoArchive::Entry>& entries, const size_t objective)
+		: mEntries(entries), mObjective(objective) {}
+
+		bool operator()(const size_t a, const size_t b) const {
+			return mEntries[a].objectives[mObjective] < mEntries[b].objectives[mObjective];
+		}
+
+	private:
+		const std::vector<ParetoArchive::Entry>& mEntries;
+		size_t mObjective;
+	};
+
+	ParetoArchive::ParetoArchive (const size_t numObjectives, const size_t capacity)
+	: mNumObjectives(numObjectives), mCapacity(capacity), mAreDistancesValid(false) {
+		if (mNumObjectives == 0) {
+			throw std::invalid_argument("ParetoArchive: there must be at least one objective");
+		}
+	}
+
+	bool ParetoArchive::add (const Position& position, const Objectives& objectives) {
+		if (objectives.size() != mNumObjectives) {
+			throw std::invalid_argument("ParetoArchive: wrong number of objectives");
+		}
+		if ( hasFailedObjective(objectives) || (mCapacity == 0) ) {
+			return false;
+		}
+
+		for (size_t i = 0; i < mEntries.size(); i++) {
+			const Objectives& member = mEntries[i].objectives;
+			if ( dominates(member, objectives) || (member == objectives) ) {
+				return false;
+			}
+		}
+
+		// Drop the members the new solution dominates, keeping the others
+		// at the front
+		size_t kept = 0;
+		for (size_t i = 0; i < mEntries.size(); i++) {
+			if (!dominates(objectives, mEntries[i].objectives)) {
+				if (kept != i) {
+					mEntries[kept].position.swap( mEntries[i].position );
+					mEntries[kept].objectives.swap( mEntries[i].objectives );
+				}
+				kept++;
+			}
+		}
+		mEntries.resize( kept );
+
+		Entry entry;
+		entry.position = position;
+		entry.objectives = objectives;
+		mEntries.push_back( entry );
+		mAreDistancesValid = false;
+
+		if (mEntries.size() > mCapacity) {
+			pruneMostCrowded();
+		}
+		return true;
+	}
+
+	void ParetoArchive::clear () {
+		mEntries.clear();
+		mAreDistancesValid = false;
+	}
+
+	size_t ParetoArchive::numObjectives () const {
+		return mNumObjectives;
+	}
+
+	size_t ParetoArchive::capacity () const {
+		return mCapacity;
+	}
+
+	size_t ParetoArchive::size () const {
+		return mEntries.size();
+	}
+
+	bool ParetoArchive::empty () const {
+		return mEntries.empty();
+	}
+
+	const ParetoArchive::Entry& ParetoArchive::entry (const size_t i) const {
+		return mEntries.at(i);
+	}
+
+	double ParetoArchive::crowdingDistance (const size_t i) const {
+		updateCrowdingDistances();
+		return mCrowdingDistances.at(i);
+	}
+
+	void ParetoArchive::updateCrowdingDistances () const {
+		if (mAreDistancesValid) {
+			return;
+		}
+		mAreDistancesValid = true;
+
+		const size_t n = mEntries.size();
+		mCrowdingDistances.assign( n, 0.0 );
+		if (n < 3) {
+			mCrowdingDistances.assign( n, std::numeric_limits<double>::infinity() );
+			return;
+		}
+
+		std::vector<size_t> order( n );
+		for (size_t k = 0; k < mNumObjectives; k++) {
+			for (size_t i = 0; i < n; i++) {
+				order[i] = i;
+			}
+			std::sort( order.begin(), order.end(), ObjectiveCmp(mEntries, k) );
+
+			mCrowdingDistances[ order.front() ] = std::numeric_limits<double>::infinity();
+			mCrowdingDistances[ order.back() ] = std::numeric_limits<double>::infinity();
+
+			const double range = mEntries[ order.back() ].objectives[k] - mEntries[ order.front() ].objectives[k];
+			if (range <= 0) {
+				continue;
+			}
+
+			// Side lengths of the cuboid around each entry, normalized
+			for (size_t j = 1; j + 1 < n; j++) {
+				const double gap = mEntries[ order[j + 1] ].objectives[k] - mEntries[ order[j - 1] ].objectives[k];
+				mCrowdingDistances[ order[j] ] += gap / range;
+			}
+		}
+	}
+
+	void ParetoArchive::pruneMostCrowded () {
+		updateCrowdingDistances();
+
+		size_t crowded = 0;
+		for (size_t i = 1; i < mEntries.size(); i++) {
+			if (mCrowdingDistances[i] < mCrowdingDistances[crowded]) {
+				crowded = i;
+			}
+		}
+
+		mEntries[crowded].position.swap( mEntries.back().position );
+		mEntries[crowded].objectives.swap( mEntries.back().objectives );
+		mEntries.pop_back();
+		mAreDistancesValid = false;
+	}
+
+	// Every particle follows a leader from the archive instead of a neighbour
+	class MultiObjectiveManager::LeaderTopology : public Topology {
+	public:
+		LeaderTopology (MultiObjectiveManager* owner)
+		: Topology(owner), mOwner(owner) {}
+
+		virtual void update () {
+		}
+
+		// There is no leading particle, only the archive
+		virtual ParticleId socialBestId (const Particle& asker) {
+			return asker.id();
+		}
+
+		virtual const Position& socialBest (const Particle& asker) {
+			const int leader = mOwner->selectLeader();
+			if (leader < 0) {
+				return asker.best().position;
+			}
+			return mOwner->mArchive.entry(leader).position;
+		}
+
+	private:
+		MultiObjectiveManager* mOwner;
+	};
+
+	MultiObjectiveManager::MultiObjectiveManager (const gslseed_t seed, const size_t numDimensions, const size_t numObjectives,
+	 const size_t numParticles, const size_t numIterations, const size_t archiveCapacity)
+	: Manager(seed, numDimensions, numParticles, numIterations), mNumObjectives(numObjectives),
+	  mArchive(numObjectives, archiveCapacity) {
+		setTopology( new LeaderTopology(this) );
+		createObjectiveStates();
+	}
+
+	MultiObjectiveManager::MultiObjectiveManager (const gslseed_t seed, const size_t numDimensions, const size_t numObjectives,
+	 const size_t numParticles, const size_t numIterations, const size_t archiveCapacity,
+	 const Weight inertiaStart, const Weight inertiaEnd, const Weight cognitive, const Weight social)
+	: Manager(seed, numDimensions, numParticles, numIterations, inertiaStart, inertiaEnd, cognitive, social),
+	  mNumObjectives(numObjectives), mArchive(numObjectives, archiveCapacity) {
+		setTopology( new LeaderTopology(this) );
+		createObjectiveStates();
+	}
+
+	MultiObjectiveManager::~MultiObjectiveManager () {
+	}
+
+	size_t MultiObjectiveManager::numObjectives() const {
+		return mNumObjectives;
+	}
+
+	const ParetoArchive& MultiObjectiveManager::archive() const {
+		return mArchive;
+	}
+
+	const Objectives& MultiObjectiveManager::objectives(const ParticleId pid) const {
+		return mObjectives.at(pid);
+	}
+
+	const Objectives& MultiObjectiveManager::bestObjectives(const ParticleId pid) const {
+		return mBestObjectives.at(pid);
+	}
+
+	void MultiObjectiveManager::reset () {
+		Manager::reset();
+
+		mArchive.clear();
+		createObjectiveStates();
+	}
+
+	void MultiObjectiveManager::restart (const size_t numParticles) {
+		Manager::restart(numParticles);
+
+		// Stale objectives are harmless, acceptAsBest() checks them against
+		// the fitnesses
+		if (mObjectives.size() != this->numParticles()) {
+			mObjectives.resize( this->numParticles() );
+			mBestObjectives.resize( this->numParticles() );
+		}
+	}
+
+	void MultiObjectiveManager::createObjectiveStates () {
+		mObjectives.assign( numParticles(), Objectives() );
+		mBestObjectives.assign( numParticles(), Objectives() );
+	}
+
+	Fitness MultiObjectiveManager::scalarize (const Objectives& objectives) const {
+		Fitness sum = 0;
+		for (size_t k = 0; k < objectives.size(); k++) {
+			sum += objectives[k];
+		}
+		return sum;
+	}
+
+	Fitnesses MultiObjectiveManager::evaluate (const Positions& positions, ObjectiveVectors& objectives) {
+		objectives = evaluateObjectives( positions );
+		if (objectives.size() != positions.size()) {
+			throw std::runtime_error("MultiObjectiveManager: wrong number of objective vectors");
+		}
+
+		Fitnesses fitnesses( positions.size() );
+		for (size_t i = 0; i < positions.size(); i++) {
+			if ( (objectives[i].size() != mNumObjectives) || hasFailedObjective(objectives[i]) ) {
+				objectives[i].clear();
+				fitnesses[i] = FailedFitness();
+				continue;
+			}
+
+			fitnesses[i] = scalarize( objectives[i] );
+
+			// Like Particle, ignore positions outside of the search box
+			if (isPositionWithinBounds(positions[i])) {
+				mArchive.add( positions[i], objectives[i] );
+			}
+		}
+		return fitnesses;
+	}
+
+	Fitnesses MultiObjectiveManager::evaluateFunction (const Positions& positions ) {
+		ObjectiveVectors objectives;
+		return evaluate( positions, objectives );
+	}
+
+	Fitnesses MultiObjectiveManager::evaluateCurrentPositions () {
+		if (mObjectives.size() != numParticles()) {
+			// The swarm was recreated, e.g. by a new initializer
+			createObjectiveStates();
+		}
+
+		Positions positions;
+		positions.reserve( numParticles() );
+		for (ParticleId pid = 0; pid < numParticles(); pid++) {
+			positions.push_back( particle(pid).current().position );
+		}
+
+		return evaluate( positions, mObjectives );
+	}
+
+	bool MultiObjectiveManager::acceptAsBest (const Particle& particle) {
+		const Fitness current = particle.current().fitness;
+		const Fitness best = particle.best().fitness;
+		if ( isFailedFitness(current) || (current == WorstPossibleFitness()) ) {
+			// Failed, or outside of the search box
+			return false;
+		}
+
+		const ParticleId pid = particle.id();
+		const bool isTracked = (pid < mObjectives.size());
+
+		// The objectives are only trusted if they still match the scalar
+		// fitnesses, i.e. no other evaluation path changed the states
+		const bool isCurrentKnown = isTracked && !mObjectives[pid].empty() && (scalarize(mObjectives[pid]) == current);
+		const bool isBestKnown = isTracked && !mBestObjectives[pid].empty() && (scalarize(mBestObjectives[pid]) == best);
+
+		bool isAccepted;
+		if (best == WorstPossibleFitness()) {
+			isAccepted = true;
+		} else if (!isCurrentKnown || !isBestKnown) {
+			isAccepted = Manager::acceptAsBest(particle);
+		} else if (dominates(mObjectives[pid], mBestObjectives[pid])) {
+			isAccepted = true;
+		} else if (dominates(mBestObjectives[pid], mObjectives[pid])) {
+			isAccepted = false;
+		} else {
+			isAccepted = (uniform(0, 1) < 0.5);
+		}
+
+		if (isAccepted && isTracked) {
+			if (isCurrentKnown) {
+				mBestObjectives[pid] = mObjectives[pid];
+			} else {
+				mBestObjectives[pid].clear();
+			}
+		}
+		return isAccepted;
+	}
+
+	int MultiObjectiveManager::selectLeader () {
+		const size_t n = mArchive.size();
+		if (n == 0) {
+			return -1;
+		}
+
+		// Binary tournament, the less crowded entry wins
+		const size_t a = std::min( static_cast<size_t>( uniform(0, n) ), n - 1 );
+		const size_t b = std::min( static_cast<size_t>( uniform(0, n) ), n - 1 );
+		return static_cast<int>( mArchive.crowdingDistance(a) >= mArchive.crowdingDistance(b) ? a : b );
+	}
+
+}; // namespace
@@ -0,0 +1,154 @@
+#ifndef INC_PSO_MULTIOBJECTIVE_H
+#define INC_PSO_MULTIOBJECTIVE_H
+
+#include <vector>
+
+#include "pso_types.h"
+#include "pso_manager.h"
+
+namespace ParticleSwarmOptimization {
+
+	// One vector of objective values per position, all to be minimized
+	typedef Fitnesses Objectives;
+	typedef std::vector<Objectives> ObjectiveVectors;
+
+	// True if a is no worse than b in every objective and better in one
+	inline bool dominates (const Objectives& a, const Objectives& b) {
+		bool isBetter = false;
+		for (size_t k = 0; k < a.size(); k++) {
+			if (b[k] < a[k]) {
+				return false;
+			}
+			if (a[k] < b[k]) {
+				isBetter = true;
+			}
+		}
+		return isBetter;
+	}
+
+	// Bounded set of mutually non-dominated solutions.
+	//
+	// A new solution is rejected if a member dominates or equals it, and
+	// removes the members it dominates. Beyond capacity, the member with the
+	// smallest crowding distance (Deb et al., NSGA-II) is pruned, which keeps
+	// the front evenly spread. The extremes of every objective have an
+	// infinite crowding distance and are never pruned.
+	class ParetoArchive {
+	public:
+		struct Entry {
+			Position position;
+			Objectives objectives;
+		};
+
+		ParetoArchive (const size_t numObjectives, const size_t capacity);
+
+		// Returns false if the solution was not kept. Solutions with a NaN
+		// objective are never kept.
+		bool add (const Position& position, const Objectives& objectives);
+
+		void clear ();
+
+		size_t numObjectives () const;
+		size_t capacity () const;
+		size_t size () const;
+		bool empty () const;
+
+		const Entry& entry (const size_t i) const;
+
+		// Crowding distance of an entry, larger in sparser regions of the
+		// front. Recomputed on the first call after a change.
+		double crowdingDistance (const size_t i) const;
+
+	private:
+		void updateCrowdingDistances () const;
+		void pruneMostCrowded ();
+
+		size_t mNumObjectives;
+		size_t mCapacity;
+		std::vector<Entry> mEntries;
+
+		mutable std::vector<double> mCrowdingDistances;
+		mutable bool mAreDistancesValid;
+	};
+
+	// Multi-objective PSO (MOPSO). The solutions that no other evaluated
+	// solution dominates are kept in a bounded ParetoArchive, which is the
+	// result of a run.
+	//
+	// Instead of a neighbour's best, every particle follows a leader drawn
+	// from the archive by a binary tournament on crowding distance, which
+	// favours the sparse parts of the front. A new position becomes a
+	// particle's best if it dominates it, and with probability one half if
+	// neither dominates the other.
+	//
+	// Inherit from this class and implement evaluateObjectives(). The
+	// driving loop, budgets and diagnostics are those of Manager. The scalar
+	// fitness Manager sees, e.g. in getFitness(), is scalarize() of the
+	// objectives. Setting another topology replaces the leader selection.
+	// Delta, noisy and lazy evaluation, the local search and migration
+	// between swarms work on scalar fitnesses and are not available.
+	class MultiObjectiveManager : public Manager {
+	public:
+		// Standard PSO
+		MultiObjectiveManager (const gslseed_t seed, const size_t numDimensions, const size_t numObjectives,
+		 const size_t numParticles, const size_t numIterations, const size_t archiveCapacity = 100);
+
+		// Linear PSO
+		MultiObjectiveManager (const gslseed_t seed, const size_t numDimensions, const size_t numObjectives,
+		 const size_t numParticles, const size_t numIterations, const size_t archiveCapacity,
+		 const Weight inertiaStart, const Weight inertiaEnd, const Weight cognitive, const Weight social);
+
+		virtual ~MultiObjectiveManager ();
+
+		size_t numObjectives() const;
+
+		// The non-dominated solutions found so far, which survive restarts
+		const ParetoArchive& archive() const;
+
+		// Objectives of a particle's current and best positions. Empty
+		// before the particle is first evaluated.
+		const Objectives& objectives(const ParticleId pid) const;
+		const Objectives& bestObjectives(const ParticleId pid) const;
+
+		virtual void reset();
+		virtual void restart(const size_t numParticles);
+
+	protected:
+		// This should evaluate numObjectives() objectives for every position.
+		// A failed evaluation may return an empty vector.
+		virtual ObjectiveVectors evaluateObjectives (const Positions& positions ) = 0;
+
+		// The scalar fitness handed to Manager. The default is the sum of
+		// the objectives.
+		virtual Fitness scalarize (const Objectives& objectives) const;
+
+		virtual Fitnesses evaluateFunction (const Positions& positions );
+		virtual Fitnesses evaluateCurrentPositions ();
+		virtual bool acceptAsBest (const Particle& particle);
+
+	private:
+		MultiObjectiveManager (const MultiObjectiveManager&);
+		void operator=(const MultiObjectiveManager&);
+
+		class LeaderTopology;
+		friend class LeaderTopology;
+
+		// Evaluates the positions and archives the non-dominated ones
+		Fitnesses evaluate (const Positions& positions, ObjectiveVectors& objectives);
+
+		// Archive entry followed by a particle, or -1 if the archive is empty
+		int selectLeader ();
+
+		void createObjectiveStates ();
+
+		size_t mNumObjectives;
+		ParetoArchive mArchive;
+
+		// Parallel to the particles of Manager
+		ObjectiveVectors mObjectives;
+		ObjectiveVectors mBestObjectives;
+	};
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_MULTIOBJECTIVE_H
@@ -15,7 +15,9 @@ namespace ParticleSwarmOptimization {
 	}
 
 	Particle::Particle ( Manager* man, const Particle::State& initialState, const ParticleId id )
-	: mManager (man), mId (id), mCurrent (initialState), mBest (initialState) {
+	: mManager (man), mId (id), mCurrent (initialState), mBest (initialState),
+	  mBestNumSamples (initialState.fitness != WorstPossibleFitness() ? 1 : 0), mBestM2 (0),
+	  mNumClampedComponents (0), mDisplacement (0), mHasEvaluatedFitness (false), mEvaluatedFitness (initialState.fitness), mPreviousFitness (initialState.fitness) {
 	}
 
 	void Particle::iterate() {
@@ -31,17 +33,23 @@ namespace ParticleSwarmOptimization {
 
 	void Particle::evolveVelocity () {
 		const Position& socialBest = mManager->socialBest( *this );
+
+		// The weights are constant during the update of one particle
+		const VecCom inertia = static_cast<VecCom>( mManager->inertiaWeight() );
+		const VecCom social = static_cast<VecCom>( mManager->socialWeight() );
+		const VecCom cognitive = static_cast<VecCom>( mManager->cognitiveWeight() );
+
 		for (Velocity::size_type d = 0; d < mCurrent.velocity.size(); ++d) {
 			// inertia term
-			const VecCom vInertia = mManager->inertiaWeight() * mCurrent.velocity[d];
+			const VecCom vInertia = inertia * mCurrent.velocity[d];
 
 			// social term
-			const double u1 = mManager->uniform(0,1);
-			const VecCom vSocial = mManager->socialWeight() * u1 * ( socialBest[d] - mCurrent.position[d] );
+			const VecCom u1 = static_cast<VecCom>( mManager->uniform(0,1) );
+			const VecCom vSocial = social * u1 * ( socialBest[d] - mCurrent.position[d] );
 
 			// cognitive term
-			const double u2 = mManager->uniform(0,1);
-			const VecCom vCognitive = mManager->cognitiveWeight() * u2 * ( mBest.position[d] - mCurrent.position[d] );
+			const VecCom u2 = static_cast<VecCom>( mManager->uniform(0,1) );
+			const VecCom vCognitive = cognitive * u2 * ( mBest.position[d] - mCurrent.position[d] );
 
 			mCurrent.velocity[d] = ( vInertia + vSocial + vCognitive );
 		}		
@@ -49,21 +57,46 @@ namespace ParticleSwarmOptimization {
 	}
 
 	void Particle::evolvePosition () {
-		for (Position::size_type d = 0; d < mCurrent.position.size(); ++d) {
-			mCurrent.position[d] = ( mCurrent.position[d] + mCurrent.velocity[d] );
+		if (mManager->isEnabledDeltaEvaluation()) {
+			// Remember what changed, for incremental evaluation
+			mPreviousFitness = mEvaluatedFitness;
+			mChangedDimensions.clear();
+			mPreviousValues.clear();
+			for (Position::size_type d = 0; d < mCurrent.position.size(); ++d) {
+				const VecCom previous = mCurrent.position[d];
+				mCurrent.position[d] = ( previous + mCurrent.velocity[d] );
+				if (mCurrent.position[d] != previous) {
+					mChangedDimensions.push_back( d );
+					mPreviousValues.push_back( previous );
+				}
+			}
+		} else if (mManager->isEnabledLazyEvaluation()) {
+			// Accumulate the step length, for deciding whether to re-evaluate
+			double step = 0;
+			for (Position::size_type d = 0; d < mCurrent.position.size(); ++d) {
+				mCurrent.position[d] = ( mCurrent.position[d] + mCurrent.velocity[d] );
+				step += static_cast<double>( mCurrent.velocity[d] ) * mCurrent.velocity[d];
+			}
+			mDisplacement += std::sqrt( step );
+		} else {
+			for (Position::size_type d = 0; d < mCurrent.position.size(); ++d) {
+				mCurrent.position[d] = ( mCurrent.position[d] + mCurrent.velocity[d] );
+			}
 		}
 
 		applyPositionConstraint ();
 	}
 
 	void Particle::applyVelocityConstraint () {
+		mNumClampedComponents = 0;
 		if (mManager->isEnabledMaxSpeedPerDimension()) {
-			const double MAX_DIM_SPEED = mManager->maxSpeedPerDimension();
+			const VecCom MAX_DIM_SPEED = static_cast<VecCom>( mManager->maxSpeedPerDimension() );
 
 			for (size_t i = 0; i < mCurrent.velocity.size(); i++) {
 				if (std::fabs(mCurrent.velocity[i]) > MAX_DIM_SPEED) {
+					mNumClampedComponents++;
 					if (mCurrent.velocity[i] < 0) {
-						mCurrent.velocity[i] = -1.0 * MAX_DIM_SPEED;
+						mCurrent.velocity[i] = -MAX_DIM_SPEED;
 					} else {
 						mCurrent.velocity[i] = MAX_DIM_SPEED;
 					}
@@ -94,6 +127,10 @@ namespace ParticleSwarmOptimization {
 	// The manager calls this
 	void Particle::updateFitness (const Fitness fitness) {
 		mCurrent.fitness = fitness;
+		mEvaluatedFitness = fitness;
+		mDisplacement = 0;
+		// A failed evaluation cannot be updated incrementally
+		mHasEvaluatedFitness = !isFailedFitness(fitness);
 
 		// !Fixme
 		// We are getting rid of the evaluation if outside the bounds.
@@ -118,9 +155,82 @@ namespace ParticleSwarmOptimization {
 		return mCurrent;
 	}
 
+	void Particle::replaceState (const State& state) {
+		mCurrent = state;
+		mBest = state;
+		mBestNumSamples = (state.fitness != WorstPossibleFitness() ? 1 : 0);
+		mBestM2 = 0;
+
+		mHasEvaluatedFitness = (state.fitness != WorstPossibleFitness());
+		mEvaluatedFitness = state.fitness;
+		mDisplacement = 0;
+		mChangedDimensions.clear();
+		mPreviousValues.clear();
+	}
+
+	void Particle::improveBest (const Position& position, const Fitness fitness) {
+		if (fitness < mBest.fitness) {
+			mBest.position = position;
+			mBest.fitness = fitness;
+			mBestNumSamples = 1;
+			mBestM2 = 0;
+		}
+	}
+
+	void Particle::addBestSample (const Fitness sample) {
+		if ( isFailedFitness(sample) || (mBestNumSamples == 0) ) {
+			return;
+		}
+
+		// Welford's update of the mean and the sum of squared deviations
+		mBestNumSamples++;
+		const Fitness delta = sample - mBest.fitness;
+		mBest.fitness += delta / mBestNumSamples;
+		mBestM2 += delta * (sample - mBest.fitness);
+	}
+
+	size_t Particle::bestNumSamples() const {
+		return mBestNumSamples;
+	}
+
+	Fitness Particle::bestVariance() const {
+		return (mBestNumSamples > 1 ? mBestM2 / (mBestNumSamples - 1) : 0);
+	}
+
+	double Particle::displacementSinceEvaluation() const {
+		return mDisplacement;
+	}
+
+	void Particle::keepFitness () {
+		// Outside of the bounds, as in updateFitness()
+		mCurrent.fitness = ( isPositionWithinBounds(current().position) ? mEvaluatedFitness : WorstPossibleFitness() );
+	}
+
+	size_t Particle::numClampedComponents() const {
+		return mNumClampedComponents;
+	}
+
+	bool Particle::hasPreviousFitness() const {
+		return mHasEvaluatedFitness;
+	}
+
+	Fitness Particle::previousFitness() const {
+		return mPreviousFitness;
+	}
+
+	const std::vector<size_t>& Particle::changedDimensions() const {
+		return mChangedDimensions;
+	}
+
+	const std::vector<VecCom>& Particle::previousValues() const {
+		return mPreviousValues;
+	}
+
 	void Particle::updateBest () {
-		if (mCurrent.fitness < mBest.fitness) {
+		if (mManager->acceptAsBest( *this )) {
 			mBest = mCurrent;
+			mBestNumSamples = 1;
+			mBestM2 = 0;
 		}
 	}
 
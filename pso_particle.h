@@ -1,12 +1,17 @@
 #ifndef INC_PSO_PARTICLE_H
 #define INC_PSO_PARTICLE_H
 
+#include <vector>
+
 #include "pso_types.h"
 
 namespace ParticleSwarmOptimization {
 
 class Manager;
 
+// True if every component lies in the [-1, 1] search box
+bool isPositionWithinBounds(const Position& pos);
+
 class Particle {
 	public:
 		struct State {
@@ -33,6 +38,44 @@ class Particle {
 
 		const State& current() const;
 
+		// Overwrites both the current and the best state
+		void replaceState (const State& state);
+
+		// Replaces the best state by a better point found elsewhere, e.g. by
+		// a local search. The current state is kept.
+		void improveBest (const Position& position, const Fitness fitness);
+
+		// Adds a re-evaluation of the best position. The best fitness becomes
+		// the mean of all its samples.
+		void addBestSample (const Fitness sample);
+
+		// Number of samples averaged into the best fitness, and their variance
+		// (zero with fewer than two samples)
+		size_t bestNumSamples() const;
+		Fitness bestVariance() const;
+
+		// Number of velocity components limited by the maximum speed in the
+		// last move
+		size_t numClampedComponents() const;
+
+		// Length of the path moved since the position was last evaluated.
+		// Only tracked while the manager has lazy evaluation enabled.
+		double displacementSinceEvaluation() const;
+
+		// Gives the current position the fitness of the last evaluated one,
+		// without evaluating it. The best state is not changed.
+		void keepFitness ();
+
+		// Fitness returned by the evaluator for the previous position, before
+		// any out-of-bounds penalty. Only meaningful if hasPreviousFitness().
+		bool hasPreviousFitness() const;
+		Fitness previousFitness() const;
+
+		// The dimensions changed by the last move and their values before it.
+		// Only recorded while the manager has delta evaluation enabled.
+		const std::vector<size_t>& changedDimensions() const;
+		const std::vector<VecCom>& previousValues() const;
+
 	protected:
 		void evolveVelocity ();
 
@@ -55,6 +98,18 @@ class Particle {
 
 		State mCurrent;
 		State mBest;
+
+		size_t mBestNumSamples;
+		Fitness mBestM2;
+
+		size_t mNumClampedComponents;
+		double mDisplacement;
+
+		bool mHasEvaluatedFitness;
+		Fitness mEvaluatedFitness;
+		Fitness mPreviousFitness;
+		std::vector<size_t> mChangedDimensions;
+		std::vector<VecCom> mPreviousValues;
 	};
 
 }; // namespace
@@ -0,0 +1,217 @@
+#include <stdexcept>
+
+#include "pso_pipeline.h"
+
+#include "pso_particle.h"
+
+#include "pso_thread.h"
+
+namespace ParticleSwarmOptimization {
+
+	EvaluationTicket::EvaluationTicket (PipelinedManager* owner, const ParticleId first)
+	: mOwner(owner), mFirst(first), mIsInFlight(false), mIsDone(false) {
+	}
+
+	const Positions& EvaluationTicket::positions() const {
+		return mPositions;
+	}
+
+	void EvaluationTicket::complete (const Fitnesses& fitnesses) {
+		ScopedLock lock(*mOwner->mMutex);
+		mFitnesses = fitnesses;
+		mIsDone = true;
+		mOwner->mCompleted->broadcast();
+	}
+
+	PipelinedManager::PipelinedManager (const gslseed_t seed, const size_t numDimensions, const size_t numParticles, const size_t numIterations,
+	 const size_t numChunks, const Mode mode)
+	: Manager(seed, numDimensions, numParticles, numIterations), mNumChunks(numChunks), mMode(mode) {
+		mMutex = new Mutex();
+		mCompleted = new Condition();
+		createTickets();
+	}
+
+	PipelinedManager::PipelinedManager (const gslseed_t seed, const size_t numDimensions, const size_t numParticles, const size_t numIterations,
+	 const Weight inertiaStart, const Weight inertiaEnd, const Weight cognitive, const Weight social,
+	 const size_t numChunks, const Mode mode)
+	: Manager(seed, numDimensions, numParticles, numIterations, inertiaStart, inertiaEnd, cognitive, social),
+	  mNumChunks(numChunks), mMode(mode) {
+		mMutex = new Mutex();
+		mCompleted = new Condition();
+		createTickets();
+	}
+
+	PipelinedManager::~PipelinedManager () {
+		// Evaluators may still hold tickets
+		drain();
+		destroyTickets();
+
+		delete mCompleted;
+		delete mMutex;
+	}
+
+	size_t PipelinedManager::numChunks() const {
+		return mNumChunks;
+	}
+
+	PipelinedManager::Mode PipelinedManager::mode() const {
+		return mMode;
+	}
+
+	void PipelinedManager::createTickets () {
+		if (mNumChunks == 0) {
+			throw std::invalid_argument("PipelinedManager: number of chunks must be positive");
+		}
+
+		// Split the swarm into chunks of (nearly) equal size
+		const size_t np = numParticles();
+		const size_t nc = (mNumChunks < np ? mNumChunks : np);
+		ParticleId first = 0;
+		for (size_t c = 0; c < nc; c++) {
+			const ParticleId end = first + np / nc + (c < np % nc ? 1 : 0);
+			mTickets.push_back( new EvaluationTicket(this, first) );
+			mChunkEnd.push_back( end );
+			first = end;
+		}
+	}
+
+	void PipelinedManager::destroyTickets () {
+		while (!mTickets.empty()) {
+			delete mTickets.back();
+			mTickets.pop_back();
+		}
+		mChunkEnd.clear();
+	}
+
+	void PipelinedManager::reset() {
+		// The swarm is recreated with its initial size, which a restart
+		// may have changed
+		drain();
+		Manager::reset();
+
+		destroyTickets();
+		createTickets();
+	}
+
+	void PipelinedManager::restart(const size_t numParticles) {
+		// No result may arrive for a particle that no longer exists
+		drain();
+		Manager::restart(numParticles);
+
+		destroyTickets();
+		createTickets();
+	}
+
+	void PipelinedManager::iterate () {
+		if (isEnabledNoisyEvaluation()) {
+			// The re-evaluations do not fit in the chunks, and the budget would reserve them anyway
+			throw std::logic_error("PipelinedManager: noisy evaluation is not available");
+		}
+		if (isEnabledLazyEvaluation()) {
+			// Every chunk is evaluated as a whole
+			throw std::logic_error("PipelinedManager: lazy evaluation is not available");
+		}
+		if (isEnabledDeltaEvaluation()) {
+			// Chunks are evaluated with evaluateFunction() only
+			throw std::logic_error("PipelinedManager: delta evaluation is not available");
+		}
+
+		prepareParticles();
+
+		updateTopology();
+
+		for (size_t c = 0; c < mTickets.size(); c++) {
+			EvaluationTicket* ticket = mTickets[c];
+
+			if (mMode == Asynchronous) {
+				// Use whatever has arrived so far
+				applyCompleted();
+			}
+			if (ticket->mIsInFlight) {
+				waitFor(c);
+				apply(ticket);
+			}
+
+			// Move this chunk while the previous chunks are being evaluated
+			ticket->mPositions.clear();
+			for (ParticleId pid = ticket->mFirst; pid < mChunkEnd[c]; pid++) {
+				moveParticle(pid);
+				ticket->mPositions.push_back( particle(pid).current().position );
+			}
+
+			ticket->mIsDone = false;
+			ticket->mIsInFlight = true;
+			submitEvaluation(ticket);
+		}
+
+		if (mMode == Generational) {
+			drain();
+		} else {
+			applyCompleted();
+		}
+
+		updateBestSoFar();
+
+		finishIteration();
+
+		if ( (mMode == Asynchronous) && !keepLooping() ) {
+			// Last iteration of the run: collect the stragglers
+			drain();
+			updateBestSoFar();
+			publishSnapshot();
+		}
+	}
+
+	size_t PipelinedManager::pendingEvaluations() const {
+		size_t count = 0;
+		for (size_t c = 0; c < mTickets.size(); c++) {
+			if (mTickets[c]->mIsInFlight) {
+				count += mTickets[c]->mPositions.size();
+			}
+		}
+		return count;
+	}
+
+	void PipelinedManager::submitEvaluation (EvaluationTicket* ticket) {
+		ticket->complete( evaluateFunction(ticket->positions()) );
+	}
+
+	void PipelinedManager::drain () {
+		for (size_t c = 0; c < mTickets.size(); c++) {
+			if (mTickets[c]->mIsInFlight) {
+				waitFor(c);
+				apply(mTickets[c]);
+			}
+		}
+	}
+
+	void PipelinedManager::waitFor (const size_t chunk) {
+		ScopedLock lock(*mMutex);
+		while (!mTickets[chunk]->mIsDone) {
+			mCompleted->wait(*mMutex);
+		}
+	}
+
+	void PipelinedManager::applyCompleted () {
+		for (size_t c = 0; c < mTickets.size(); c++) {
+			bool isDone;
+			{
+				ScopedLock lock(*mMutex);
+				isDone = mTickets[c]->mIsDone;
+			}
+			if (mTickets[c]->mIsInFlight && isDone) {
+				apply(mTickets[c]);
+			}
+		}
+	}
+
+	// Called on the optimizer thread only, so particles are never updated concurrently
+	void PipelinedManager::apply (EvaluationTicket* ticket) {
+		if (ticket->mFitnesses.size() != ticket->mPositions.size()) {
+			throw std::runtime_error("PipelinedManager: evaluator returned the wrong number of fitnesses");
+		}
+		ticket->mIsInFlight = false;
+		assignFitnesses(ticket->mFirst, ticket->mFitnesses);
+	}
+
+}; // namespace
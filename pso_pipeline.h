@@ -0,0 +1,108 @@
+#ifndef INC_PSO_PIPELINE_H
+#define INC_PSO_PIPELINE_H
+
+#include <vector>
+
+#include "pso_manager.h"
+
+namespace ParticleSwarmOptimization {
+
+	class Condition;
+	class PipelinedManager;
+
+	// A batch of positions handed to PipelinedManager::submitEvaluation().
+	// The evaluator must call complete() exactly once, from any thread.
+	class EvaluationTicket {
+	public:
+		const Positions& positions() const;
+
+		void complete (const Fitnesses& fitnesses);
+
+	private:
+		friend class PipelinedManager;
+
+		EvaluationTicket (PipelinedManager* owner, const ParticleId first);
+
+		EvaluationTicket (const EvaluationTicket&);
+		void operator=(const EvaluationTicket&);
+
+		PipelinedManager* mOwner;
+		ParticleId mFirst;
+		Positions mPositions;
+		Fitnesses mFitnesses;
+		bool mIsInFlight;
+		bool mIsDone;
+	};
+
+	// Splits the swarm into chunks and overlaps moving the particles of one
+	// chunk with the evaluation of the chunks submitted before it.
+	//
+	// Generational mode keeps the semantics of Manager: results are applied
+	// only once the whole swarm has been evaluated. Asynchronous mode applies
+	// results as soon as they arrive and lets evaluations of the last chunks
+	// run on into the next iteration; a chunk only waits for its own previous
+	// evaluation before it moves again.
+	//
+	// Inherit from this class instead of Manager and override
+	// submitEvaluation() to evaluate asynchronously. The default calls
+	// evaluateFunction() synchronously. Noisy, lazy and delta evaluation are
+	// not available, estimate() throws std::logic_error when one is enabled.
+	class PipelinedManager : public Manager {
+	public:
+		enum Mode {
+			Generational,
+			Asynchronous
+		};
+
+		// Standard PSO
+		PipelinedManager (const gslseed_t seed, const size_t numDimensions, const size_t numParticles, const size_t numIterations,
+		 const size_t numChunks, const Mode mode = Generational);
+
+		// Linear PSO
+		PipelinedManager (const gslseed_t seed, const size_t numDimensions, const size_t numParticles, const size_t numIterations,
+		 const Weight inertiaStart, const Weight inertiaEnd, const Weight cognitive, const Weight social,
+		 const size_t numChunks, const Mode mode = Generational);
+
+		virtual ~PipelinedManager ();
+
+		size_t numChunks() const;
+		Mode mode() const;
+
+		// Blocks until no evaluation is in flight and applies all results
+		void drain ();
+
+		virtual void reset();
+		virtual void restart(const size_t numParticles);
+
+	protected:
+		virtual void iterate ();
+
+		// Positions of the chunks still being evaluated
+		virtual size_t pendingEvaluations() const;
+
+		// Starts the evaluation of the ticket's positions
+		virtual void submitEvaluation (EvaluationTicket* ticket);
+
+	private:
+		friend class EvaluationTicket;
+
+		void createTickets ();
+		void destroyTickets ();
+
+		void waitFor (const size_t chunk);
+		void applyCompleted ();
+		void apply (EvaluationTicket* ticket);
+
+		size_t mNumChunks;
+		Mode mMode;
+
+		std::vector<EvaluationTicket*> mTickets;
+		std::vector<ParticleId> mChunkEnd;
+
+		Mutex* mMutex;
+		Condition* mCompleted;
+	};
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_PIPELINE_H
@@ -0,0 +1,357 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "pso_resilient.h"
+
+#include "pso_manager.h"
+
+#include "pso_thread.h"
+
+#include "pso_timer.h"
+
+namespace ParticleSwarmOptimization {
+
+	class ResilientEvaluator::Worker : public Runnable {
+	public:
+		Worker (ResilientEvaluator* evaluator)
+		: mEvaluator(evaluator) {}
+
+		virtual void run () {
+			mEvaluator->work();
+		}
+
+	private:
+		ResilientEvaluator* mEvaluator;
+	};
+
+	ResilientEvaluator::ResilientEvaluator (PointEvaluator& evaluator, const EvaluationPolicy& policy)
+	: mEvaluator(evaluator), mPolicy(policy), mBatch(0), mNumDone(0), mPositions(0), mIsStopping(false), mNumBusy(0), mStalledSince(0) {
+		if (mPolicy.numThreads == 0) {
+			throw std::invalid_argument("ResilientEvaluator: at least one thread is needed");
+		}
+
+		mBatchMutex = new Mutex();
+		mMutex = new Mutex();
+		mAttemptQueued = new Condition();
+		mPointDone = new Condition();
+
+		for (size_t i = 0; i < mPolicy.numThreads; i++) {
+			startWorker();
+		}
+	}
+
+	ResilientEvaluator::~ResilientEvaluator () {
+		{
+			ScopedLock lock(*mMutex);
+			mIsStopping = true;
+			mAttemptQueued->broadcast();
+		}
+		for (size_t i = 0; i < mThreads.size(); i++) {
+			delete mThreads[i];
+			delete mWorkers[i];
+		}
+
+		delete mPointDone;
+		delete mAttemptQueued;
+		delete mMutex;
+		delete mBatchMutex;
+	}
+
+	void ResilientEvaluator::startWorker () {
+		mWorkers.push_back( new Worker(this) );
+		mThreads.push_back( new Thread(mWorkers.back()) );
+		mThreads.back()->start();
+	}
+
+	Fitnesses ResilientEvaluator::evaluate (const Positions& positions) {
+		ScopedLock batchLock(*mBatchMutex);
+		if (positions.empty()) {
+			return Fitnesses();
+		}
+
+		ScopedLock lock(*mMutex);
+		mPositions = &positions;
+		mNumDone = 0;
+		mStalledSince = 0;
+
+		Point initial;
+		initial.fitness = FailedFitness();
+		initial.isDone = false;
+		initial.numRunning = 0;
+		initial.numRetries = 0;
+		initial.isSpeculated = false;
+		initial.queuedAt = monotonicSeconds();
+		mPoints.assign( positions.size(), initial );
+		mStatistics.numPoints += positions.size();
+
+		for (size_t i = 0; i < positions.size(); i++) {
+			queueAttempt(i, positions[i], false);
+		}
+
+		while (mNumDone < mPoints.size()) {
+			abandonTimedOutAttempts();
+			speculate();
+			ensureProgress();
+			if (mNumDone == mPoints.size()) {
+				break;
+			}
+
+			const double deadline = nextDeadline();
+			if (deadline > 0) {
+				mPointDone->timedWait(*mMutex, std::max(0.0, deadline - monotonicSeconds()));
+			} else {
+				mPointDone->wait(*mMutex);
+			}
+		}
+
+		// Attempts still queued or running now belong to a finished batch
+		mBatch++;
+		mPending.clear();
+		mPositions = 0;
+
+		Fitnesses fitnesses( mPoints.size() );
+		for (size_t i = 0; i < mPoints.size(); i++) {
+			fitnesses[i] = mPoints[i].fitness;
+		}
+		return fitnesses;
+	}
+
+	void ResilientEvaluator::work () {
+		ScopedLock lock(*mMutex);
+		for (;;) {
+			while (mQueue.empty() && !mIsStopping) {
+				mAttemptQueued->wait(*mMutex);
+			}
+			if (mQueue.empty()) {
+				return;
+			}
+
+			Attempt* attempt = mQueue.front();
+			mQueue.pop_front();
+
+			// Skip attempts that are no longer needed
+			if ( (attempt->batch != mBatch) || attempt->isAbandoned ) {
+				delete attempt;
+				continue;
+			}
+			if (mPoints[attempt->index].isDone) {
+				mPending.erase(attempt->pending);
+				mPoints[attempt->index].numRunning--;
+				delete attempt;
+				continue;
+			}
+			attempt->isStarted = true;
+			attempt->startedAt = monotonicSeconds();
+			if (mPolicy.timeout > 0) {
+				// Let evaluate() wait for the new deadline
+				mPointDone->signal();
+			}
+
+			mNumBusy++;
+			mMutex->unlock();
+			bool isSuccess = true;
+			Fitness fitness = FailedFitness();
+			try {
+				fitness = mEvaluator.evaluate( attempt->position );
+				isSuccess = !isFailedFitness(fitness);
+			} catch (...) {
+				isSuccess = false;
+			}
+			mMutex->lock();
+			mNumBusy--;
+
+			finishAttempt(attempt, isSuccess, fitness);
+			mPointDone->signal();
+		}
+	}
+
+	void ResilientEvaluator::queueAttempt (const size_t index, const Position& position, const bool isSpeculative) {
+		Attempt* attempt = new Attempt();
+		attempt->batch = mBatch;
+		attempt->index = index;
+		attempt->position = position;
+		attempt->queuedAt = monotonicSeconds();
+		attempt->startedAt = 0;
+		attempt->isStarted = false;
+		attempt->isAbandoned = false;
+		attempt->isSpeculative = isSpeculative;
+		attempt->pending = mPending.insert(mPending.end(), attempt);
+
+		mQueue.push_back(attempt);
+		mPoints[index].numRunning++;
+		mStatistics.numAttempts++;
+		if (isSpeculative) {
+			mStatistics.numSpeculative++;
+		}
+		mAttemptQueued->signal();
+	}
+
+	void ResilientEvaluator::finishAttempt (Attempt* attempt, const bool isSuccess, const Fitness fitness) {
+		if (attempt->batch != mBatch) {
+			delete attempt;
+			return;
+		}
+
+		Point& point = mPoints[attempt->index];
+		if (!attempt->isAbandoned) {
+			mPending.erase(attempt->pending);
+			point.numRunning--;
+		}
+
+		if (!isSuccess) {
+			mStatistics.numErrors++;
+		}
+
+		if (isSuccess && !point.isDone) {
+			// Late results of abandoned attempts are still welcome
+			point.fitness = fitness;
+			point.isDone = true;
+			mNumDone++;
+			mStatistics.latency.add( monotonicSeconds() - point.queuedAt );
+			if (attempt->isSpeculative) {
+				mStatistics.numSpeculativeWins++;
+			}
+		} else if (!isSuccess && !attempt->isAbandoned) {
+			attemptEnded(attempt->index, attempt->position);
+		}
+
+		delete attempt;
+	}
+
+	// Retries the point, or gives up on it, once none of its attempts is left
+	void ResilientEvaluator::attemptEnded (const size_t index, const Position& position) {
+		Point& point = mPoints[index];
+		if ( point.isDone || (point.numRunning > 0) ) {
+			return;
+		}
+
+		if (point.numRetries < mPolicy.maxRetries) {
+			point.numRetries++;
+			mStatistics.numRetries++;
+			queueAttempt(index, position, false);
+		} else {
+			point.fitness = FailedFitness();
+			point.isDone = true;
+			mNumDone++;
+			mStatistics.numFailed++;
+		}
+	}
+
+	void ResilientEvaluator::abandonTimedOutAttempts () {
+		if (mPolicy.timeout <= 0) {
+			return;
+		}
+
+		const double now = monotonicSeconds();
+		std::list<Attempt*>::iterator it = mPending.begin();
+		while (it != mPending.end()) {
+			Attempt* attempt = *it;
+			// Attempts waiting for a thread are not slow, the queue is
+			if ( !attempt->isStarted || (now - attempt->startedAt < mPolicy.timeout) ) {
+				++it;
+				continue;
+			}
+
+			attempt->isAbandoned = true;
+			it = mPending.erase(it);
+			mPoints[attempt->index].numRunning--;
+			mStatistics.numTimeouts++;
+
+			// The thread is stuck with the attempt, replace it
+			if (mThreads.size() < 2 * mPolicy.numThreads) {
+				startWorker();
+			}
+
+			// The attempt may be deleted once the lock is released, but not before
+			attemptEnded(attempt->index, attempt->position);
+		}
+	}
+
+	// Without an idle thread or a running attempt of the batch, only threads
+	// stuck in abandoned or earlier attempts are left and nothing may ever
+	// wake evaluate(). Start another thread, or give up on the batch once
+	// none of them has returned within a timeout.
+	void ResilientEvaluator::ensureProgress () {
+		if (mNumDone == mPoints.size()) {
+			return;
+		}
+		bool isStalled = (mNumBusy == mThreads.size());
+		for (std::list<Attempt*>::const_iterator it = mPending.begin(); isStalled && (it != mPending.end()); ++it) {
+			isStalled = !(*it)->isStarted;
+		}
+		if (!isStalled) {
+			mStalledSince = 0;
+			return;
+		}
+
+		if (mThreads.size() < 2 * mPolicy.numThreads) {
+			startWorker();
+			return;
+		}
+		// Without a timeout, wait for the threads however long they take
+		if (mPolicy.timeout <= 0) {
+			return;
+		}
+		const double now = monotonicSeconds();
+		if (mStalledSince == 0) {
+			mStalledSince = now;
+		}
+		if (now - mStalledSince < mPolicy.timeout) {
+			return;
+		}
+
+		for (size_t i = 0; i < mPoints.size(); i++) {
+			Point& point = mPoints[i];
+			if (!point.isDone) {
+				point.fitness = FailedFitness();
+				point.isDone = true;
+				mNumDone++;
+				mStatistics.numFailed++;
+			}
+		}
+	}
+
+	void ResilientEvaluator::speculate () {
+		if ( (mPolicy.speculationFraction <= 0) || (mNumDone < mPolicy.speculationFraction * mPoints.size()) ) {
+			return;
+		}
+
+		for (size_t i = 0; i < mPoints.size(); i++) {
+			Point& point = mPoints[i];
+			if ( !point.isDone && !point.isSpeculated && (point.numRunning == 1) ) {
+				point.isSpeculated = true;
+				queueAttempt(i, (*mPositions)[i], true);
+			}
+		}
+	}
+
+	double ResilientEvaluator::nextDeadline () const {
+		if (mPolicy.timeout <= 0) {
+			return 0;
+		}
+
+		// Only running attempts can time out, and a stall
+		double earliest = mStalledSince;
+		for (std::list<Attempt*>::const_iterator it = mPending.begin(); it != mPending.end(); ++it) {
+			if ( (*it)->isStarted && ( (earliest == 0) || ((*it)->startedAt < earliest) ) ) {
+				earliest = (*it)->startedAt;
+			}
+		}
+		return (earliest > 0 ? earliest + mPolicy.timeout : 0);
+	}
+
+	const EvaluationPolicy& ResilientEvaluator::policy () const {
+		return mPolicy;
+	}
+
+	ResilienceStatistics ResilientEvaluator::statistics () const {
+		ScopedLock lock(*mMutex);
+		return mStatistics;
+	}
+
+	void ResilientEvaluator::resetStatistics () {
+		ScopedLock lock(*mMutex);
+		mStatistics = ResilienceStatistics();
+	}
+
+}; // namespace
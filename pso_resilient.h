@@ -0,0 +1,158 @@
+#ifndef INC_PSO_RESILIENT_H
+#define INC_PSO_RESILIENT_H
+
+#include <deque>
+#include <list>
+#include <vector>
+
+#include "pso_types.h"
+#include "pso_evaluator.h"
+#include "pso_statistics.h"
+
+namespace ParticleSwarmOptimization {
+
+	class Mutex;
+	class Condition;
+	class Thread;
+
+	// How a ResilientEvaluator deals with slow and failing evaluations
+	struct EvaluationPolicy {
+		EvaluationPolicy ()
+		: numThreads(4), timeout(0), speculationFraction(0), maxRetries(0) {}
+
+		size_t numThreads;
+
+		// Seconds after which an attempt is abandoned, counted from when a
+		// thread started it. Zero means no timeout.
+		double timeout;
+
+		// Once this fraction of a batch is done, every point still pending is
+		// also started a second time and the first result wins. Zero disables
+		// speculative execution.
+		double speculationFraction;
+
+		// Extra attempts of a point after its attempts failed or timed out
+		size_t maxRetries;
+	};
+
+	// Instrumentation of a ResilientEvaluator
+	struct ResilienceStatistics {
+		ResilienceStatistics ()
+		: numPoints(0), numAttempts(0), numRetries(0), numTimeouts(0), numErrors(0),
+		  numSpeculative(0), numSpeculativeWins(0), numFailed(0) {}
+
+		size_t numPoints;
+		size_t numAttempts;
+		size_t numRetries;
+		size_t numTimeouts;
+		size_t numErrors;
+		size_t numSpeculative;
+		size_t numSpeculativeWins;
+
+		// Points reported as FailedFitness()
+		size_t numFailed;
+
+		// Seconds from queueing to the first result, of the points that succeeded
+		RunningStatistics latency;
+	};
+
+	// Evaluates the points of a batch in parallel on its own threads and
+	// returns once every point has a result, however slow or broken some
+	// evaluations are. Points whose attempts all failed or timed out are
+	// reported as FailedFitness(), which Manager counts apart from poor
+	// fitnesses.
+	//
+	// The point evaluator is called concurrently and must be thread safe.
+	// The same position may be evaluated more than once. An abandoned
+	// attempt keeps its thread until it returns, so a replacement thread is
+	// started, up to twice numThreads in total. When that many threads are
+	// stuck and none returns within another timeout, the points left in the
+	// batch are reported as FailedFitness().
+	// The destructor waits for all attempts to return.
+	//
+	// Batches are evaluated one at a time. To use it from a Manager, return
+	// evaluator.evaluate(positions) from evaluateFunction().
+	class ResilientEvaluator : public BatchEvaluator {
+	public:
+		// The point evaluator is not owned
+		ResilientEvaluator (PointEvaluator& evaluator, const EvaluationPolicy& policy);
+
+		virtual ~ResilientEvaluator ();
+
+		virtual Fitnesses evaluate (const Positions& positions);
+
+		const EvaluationPolicy& policy () const;
+
+		ResilienceStatistics statistics () const;
+		void resetStatistics ();
+
+	private:
+		ResilientEvaluator (const ResilientEvaluator&);
+		void operator=(const ResilientEvaluator&);
+
+		class Worker;
+		friend class Worker;
+
+		struct Point {
+			Fitness fitness;
+			bool isDone;
+			size_t numRunning;
+			size_t numRetries;
+			bool isSpeculated;
+			double queuedAt;
+		};
+
+		struct Attempt {
+			size_t batch;
+			size_t index;
+			Position position;
+			double queuedAt;
+			double startedAt;
+			bool isStarted;
+			bool isAbandoned;
+			bool isSpeculative;
+			std::list<Attempt*>::iterator pending;
+		};
+
+		void work ();
+		void startWorker ();
+
+		// These require the lock
+		void queueAttempt (const size_t index, const Position& position, const bool isSpeculative);
+		void finishAttempt (Attempt* attempt, const bool isSuccess, const Fitness fitness);
+		void attemptEnded (const size_t index, const Position& position);
+		void abandonTimedOutAttempts ();
+		void ensureProgress ();
+		void speculate ();
+		double nextDeadline () const;
+
+		PointEvaluator& mEvaluator;
+		EvaluationPolicy mPolicy;
+
+		Mutex* mBatchMutex;
+		Mutex* mMutex;
+		Condition* mAttemptQueued;
+		Condition* mPointDone;
+
+		// State of the batch in progress
+		size_t mBatch;
+		std::vector<Point> mPoints;
+		size_t mNumDone;
+		const Positions* mPositions;
+
+		std::deque<Attempt*> mQueue;
+		std::list<Attempt*> mPending;
+		bool mIsStopping;
+		// Threads inside the point evaluator
+		size_t mNumBusy;
+		// When every thread was found stuck, zero if they are not
+		double mStalledSince;
+		ResilienceStatistics mStatistics;
+
+		std::vector<Worker*> mWorkers;
+		std::vector<Thread*> mThreads;
+	};
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_RESILIENT_H
@@ -0,0 +1,92 @@
+#ifndef INC_PSO_RESTART_H
+#define INC_PSO_RESTART_H
+
+#include <cmath>
+
+#include "pso_types.h"
+#include "pso_manager.h"
+#include "pso_particle.h"
+
+namespace ParticleSwarmOptimization {
+
+// Interface to all restart strategies. The manager asks the strategy after
+// every iteration whether the swarm should be restarted.
+class RestartStrategy {
+public:
+	virtual ~RestartStrategy() {}
+
+	virtual bool shouldRestart(const Manager& manager) = 0;
+
+	// Number of particles of the restarted swarm
+	virtual size_t restartPopulation(const size_t currentPopulation) const = 0;
+
+	// Called when the manager is reset
+	virtual void reset() {}
+};
+
+// Restarts once the best fitness of the current swarm has not improved by
+// more than a relative tolerance for a number of iterations. The population
+// is multiplied by the growth factor on every restart (IPOP), up to an
+// optional maximum. A growth factor of 1 keeps the population constant.
+class StagnationRestart : public RestartStrategy {
+public:
+	StagnationRestart(const size_t patience, const double tolerance = 1e-8,
+		const double growthFactor = 2.0, const size_t maxParticles = 0)
+	: mPatience(patience), mTolerance(tolerance), mGrowthFactor(growthFactor), mMaxParticles(maxParticles) {
+		reset();
+	}
+
+	virtual bool shouldRestart(const Manager& manager) {
+		const Fitness fitness = swarmFitness(manager);
+
+		if (fitness < mReference - mTolerance * std::fabs(mReference)) {
+			mReference = fitness;
+			mIterationsWithoutImprovement = 0;
+			return false;
+		}
+
+		mIterationsWithoutImprovement++;
+		if (mIterationsWithoutImprovement >= mPatience) {
+			reset();
+			return true;
+		}
+		return false;
+	}
+
+	virtual size_t restartPopulation(const size_t currentPopulation) const {
+		size_t population = static_cast<size_t>(currentPopulation * mGrowthFactor + 0.5);
+		if ( (mMaxParticles != 0) && (population > mMaxParticles) ) {
+			population = mMaxParticles;
+		}
+		return (population > 0 ? population : 1);
+	}
+
+	virtual void reset() {
+		mReference = WorstPossibleFitness();
+		mIterationsWithoutImprovement = 0;
+	}
+
+private:
+	// Best fitness of the swarm that is currently running
+	static Fitness swarmFitness(const Manager& manager) {
+		Fitness best = WorstPossibleFitness();
+		for (size_t i = 0; i < manager.numParticles(); i++) {
+			if (manager.particle(i).best().fitness < best) {
+				best = manager.particle(i).best().fitness;
+			}
+		}
+		return best;
+	}
+
+	size_t mPatience;
+	double mTolerance;
+	double mGrowthFactor;
+	size_t mMaxParticles;
+
+	Fitness mReference;
+	size_t mIterationsWithoutImprovement;
+};
+
+} // namespace ParticleSwarmOptimization
+
+#endif // #ifndef INC_PSO_RESTART_H
@@ -0,0 +1,309 @@
+#include <stdexcept>
+
+#include "rng.h"
+
+#include "pso_sharded.h"
+
+#include "pso_particle.h"
+
+#include "pso_topology.h"
+
+#include "pso_thread.h"
+
+#include "pso_timer.h"
+
+namespace ParticleSwarmOptimization {
+
+	// Follows the shard's best particle, or the neighbouring shards' best
+	// position when that is better
+	class ShardedSwarm::ShardTopology : public GlobalTopology {
+	public:
+		ShardTopology (const Manager* const manager)
+		: GlobalTopology(manager), mExternalFitness(WorstPossibleFitness()) {}
+
+		void setExternalBest (const Position& position, const Fitness fitness) {
+			if (fitness < mExternalFitness) {
+				mExternal = position;
+				mExternalFitness = fitness;
+			}
+		}
+
+		virtual const Position& socialBest (const Particle& asker) {
+			const Particle& local = manager()->particle( socialBestId(asker) );
+			if (mExternalFitness < local.best().fitness) {
+				return mExternal;
+			}
+			return local.best().position;
+		}
+
+	private:
+		Position mExternal;
+		Fitness mExternalFitness;
+	};
+
+	// The particles of one shard, created by and only touched by its worker
+	class ShardedSwarm::Shard : public Manager {
+	public:
+		Shard (ShardedSwarm* owner, const gslseed_t seed, const size_t numDimensions, const size_t numParticles, const size_t numIterations)
+		: Manager(seed, numDimensions, numParticles, numIterations), mOwner(owner) {
+			mTopology = new ShardTopology(this);
+			setTopology(mTopology);
+		}
+
+		void step () {
+			iterate();
+		}
+
+		void setExternalBest (const Position& position, const Fitness fitness) {
+			mTopology->setExternalBest(position, fitness);
+		}
+
+	protected:
+		virtual Fitnesses evaluateFunction (const Positions& positions ) {
+			return mOwner->evaluateFunction(positions);
+		}
+
+	private:
+		ShardedSwarm* mOwner;
+		ShardTopology* mTopology;
+	};
+
+	class ShardedSwarm::Worker : public Runnable {
+	public:
+		Worker (ShardedSwarm* swarm, const size_t shard)
+		: mSwarm(swarm), mShard(shard) {}
+
+		virtual void run () {
+			mSwarm->runWorker(mShard);
+		}
+
+	private:
+		ShardedSwarm* mSwarm;
+		size_t mShard;
+	};
+
+	ShardedSwarm::ShardedSwarm (const gslseed_t seed, const size_t numDimensions, const size_t numParticles, const size_t numIterations,
+	 const size_t numShards)
+	: mNumDimensions(numDimensions), mNumParticles(numParticles), mNumIterations(numIterations), mIterationCount(0),
+	  mBestFitness(WorstPossibleFitness()), mEvaluationBudget(0), mTimeBudget(0),
+	  mRunStart(monotonicSeconds()), mRunStop(mRunStart), mCancellationToken(0), mStopReason(NotStopped),
+	  mBarrier(0), mIsRunning(false) {
+		if ( (numShards == 0) || (numShards > numParticles) ) {
+			throw std::invalid_argument("ShardedSwarm: every shard needs at least one particle");
+		}
+
+		RandomNumberGenerator rng( seed );
+		for (size_t s = 0; s < numShards; s++) {
+			mShardSeeds.push_back( rng.randomSeed() );
+		}
+
+		mShards.resize( numShards, 0 );
+		mIsPinned.resize( numShards, 0 );
+		mSummaries[0].resize( numShards );
+		mSummaries[1].resize( numShards );
+	}
+
+	ShardedSwarm::~ShardedSwarm () {
+		for (size_t s = 0; s < mShards.size(); s++) {
+			delete mShards[s];
+		}
+	}
+
+	void ShardedSwarm::setCpus (const std::vector<size_t>& cpus) {
+		mCpus = cpus;
+	}
+
+	void ShardedSwarm::setEvaluationBudget (const size_t budget) {
+		mEvaluationBudget = budget;
+	}
+
+	void ShardedSwarm::setTimeBudget (const double seconds) {
+		mTimeBudget = seconds;
+	}
+
+	void ShardedSwarm::setCancellationToken (const CancellationToken* token) {
+		mCancellationToken = token;
+	}
+
+	void ShardedSwarm::estimate () {
+		mRunStart = monotonicSeconds();
+		mStopReason = NotStopped;
+		mErrors.assign( mShards.size(), std::string() );
+
+		Barrier barrier( mShards.size() + 1 );
+		mBarrier = &barrier;
+
+		std::vector<Worker*> workers;
+		std::vector<Thread*> threads;
+		for (size_t s = 0; s < mShards.size(); s++) {
+			workers.push_back( new Worker(this, s) );
+			threads.push_back( new Thread(workers.back()) );
+			threads.back()->start();
+		}
+
+		// Wait until every shard exists
+		barrier.wait();
+
+		for (;;) {
+			mIsRunning = keepLooping();
+
+			// Start an iteration, or release the workers to exit
+			barrier.wait();
+			if (!mIsRunning) {
+				break;
+			}
+
+			// Wait for the iteration to finish
+			barrier.wait();
+			collectSummaries();
+			mIterationCount++;
+		}
+
+		for (size_t s = 0; s < threads.size(); s++) {
+			delete threads[s];
+			delete workers[s];
+		}
+		mBarrier = 0;
+
+		for (size_t s = 0; s < mErrors.size(); s++) {
+			if (!mErrors[s].empty()) {
+				throw std::runtime_error(mErrors[s]);
+			}
+		}
+	}
+
+	void ShardedSwarm::runWorker (const size_t shard) {
+		const size_t cpu = ( mCpus.empty() ? shard % numProcessors() : mCpus[shard % mCpus.size()] );
+		mIsPinned[shard] = pinCurrentThread(cpu);
+
+		// Allocated after pinning, so the particles live on this worker's node
+		try {
+			if (mShards[shard] == 0) {
+				const size_t numShards = mShards.size();
+				const size_t np = mNumParticles / numShards + (shard < mNumParticles % numShards ? 1 : 0);
+				mShards[shard] = new Shard(this, mShardSeeds[shard], mNumDimensions, np, mNumIterations);
+			}
+		} catch (const std::exception& e) {
+			mErrors[shard] = e.what();
+		}
+		mBarrier->wait();
+
+		for (;;) {
+			mBarrier->wait();
+			if (!mIsRunning) {
+				return;
+			}
+
+			if (mErrors[shard].empty()) {
+				try {
+					const size_t t = mIterationCount;
+					const size_t numShards = mShards.size();
+					const std::vector<Summary>& previous = mSummaries[(t + 1) % 2];
+					const Summary& left = previous[(shard + numShards - 1) % numShards];
+					const Summary& right = previous[(shard + 1) % numShards];
+
+					Shard* own = mShards[shard];
+					own->setExternalBest( left.position, left.fitness );
+					own->setExternalBest( right.position, right.fitness );
+					own->step();
+
+					Summary& summary = mSummaries[t % 2][shard];
+					summary.fitness = own->getFitness();
+					summary.position = own->getEstimate();
+				} catch (const std::exception& e) {
+					mErrors[shard] = e.what();
+				}
+			}
+
+			mBarrier->wait();
+		}
+	}
+
+	bool ShardedSwarm::keepLooping () {
+		bool hasFailed = false;
+		for (size_t s = 0; s < mErrors.size(); s++) {
+			hasFailed = hasFailed || !mErrors[s].empty();
+		}
+
+		if (hasFailed) {
+			mStopReason = Cancelled;
+		} else if (mIterationCount >= mNumIterations) {
+			mStopReason = MaxIterationsReached;
+		} else if ( (mEvaluationBudget != 0) && (numEvaluations() + mNumParticles > mEvaluationBudget) ) {
+			// Not enough budget left for a full iteration
+			mStopReason = EvaluationBudgetExhausted;
+		} else if ( (mTimeBudget > 0) && (monotonicSeconds() - mRunStart >= mTimeBudget) ) {
+			mStopReason = TimeBudgetExhausted;
+		} else if ( (mCancellationToken != 0) && mCancellationToken->isCancelled() ) {
+			mStopReason = Cancelled;
+		} else {
+			mStopReason = NotStopped;
+			return true;
+		}
+
+		mRunStop = monotonicSeconds();
+		return false;
+	}
+
+	void ShardedSwarm::collectSummaries () {
+		const std::vector<Summary>& current = mSummaries[mIterationCount % 2];
+		for (size_t s = 0; s < current.size(); s++) {
+			if (current[s].fitness < mBestFitness) {
+				mBestPosition = current[s].position;
+				mBestFitness = current[s].fitness;
+			}
+		}
+	}
+
+	Position ShardedSwarm::getEstimate() const {
+		return mBestPosition;
+	}
+
+	Fitness ShardedSwarm::getFitness() const {
+		return mBestFitness;
+	}
+
+	RunDiagnostics ShardedSwarm::diagnostics() const {
+		RunDiagnostics d;
+		d.reason = mStopReason;
+		d.iterations = mIterationCount;
+		d.evaluations = numEvaluations();
+		d.elapsedSeconds = ( (mStopReason == NotStopped) ? monotonicSeconds() : mRunStop ) - mRunStart;
+		return d;
+	}
+
+	size_t ShardedSwarm::numDimensions() const {
+		return mNumDimensions;
+	}
+
+	size_t ShardedSwarm::numParticles() const {
+		return mNumParticles;
+	}
+
+	size_t ShardedSwarm::numIterations() const {
+		return mNumIterations;
+	}
+
+	size_t ShardedSwarm::numShards() const {
+		return mShards.size();
+	}
+
+	size_t ShardedSwarm::iteration() const {
+		return mIterationCount;
+	}
+
+	size_t ShardedSwarm::numEvaluations() const {
+		size_t evaluations = 0;
+		for (size_t s = 0; s < mShards.size(); s++) {
+			if (mShards[s] != 0) {
+				evaluations += mShards[s]->numEvaluations();
+			}
+		}
+		return evaluations;
+	}
+
+	bool ShardedSwarm::isPinned (const size_t shard) const {
+		return mIsPinned.at(shard) != 0;
+	}
+
+}; // namespace
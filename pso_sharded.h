@@ -0,0 +1,119 @@
+#ifndef INC_PSO_SHARDED_H
+#define INC_PSO_SHARDED_H
+
+#include <string>
+#include <vector>
+
+#include "pso_types.h"
+#include "pso_manager.h"
+
+namespace ParticleSwarmOptimization {
+
+	class Barrier;
+
+	// A very large swarm split into shards, each owned by one worker thread
+	// pinned to its own processor.
+	//
+	// A worker pins itself before it creates its shard, so the shard's
+	// particles are allocated and first touched on the worker's memory node
+	// and stay there. Within a shard the particles follow the shard's best
+	// particle. Between shards only a summary (best position and fitness) is
+	// exchanged once per iteration: every shard also follows the better of
+	// its two ring neighbours' summaries, if it beats its own best.
+	//
+	// Inherit from this class and implement evaluateFunction(). It is called
+	// concurrently by the workers, each with the positions of its own shard.
+	class ShardedSwarm {
+	public:
+		ShardedSwarm (const gslseed_t seed, const size_t numDimensions, const size_t numParticles, const size_t numIterations,
+		 const size_t numShards);
+
+		virtual ~ShardedSwarm ();
+
+		// Shard s is pinned to cpus[s % cpus.size()]. By default shard s is
+		// pinned to processor s, which places consecutive shards on the same
+		// node first. Must be called before the first estimate().
+		void setCpus (const std::vector<size_t>& cpus);
+
+		// Same meaning as for Manager
+		void setEvaluationBudget (const size_t budget);
+		void setTimeBudget (const double seconds);
+		void setCancellationToken (const CancellationToken* token);
+
+		void estimate ();
+
+		Position getEstimate() const;
+		Fitness getFitness() const;
+
+		RunDiagnostics diagnostics() const;
+
+		size_t numDimensions() const;
+		size_t numParticles() const;
+		size_t numIterations() const;
+		size_t numShards() const;
+		size_t iteration() const;
+		size_t numEvaluations() const;
+
+		// Whether the worker of the shard could be pinned in the last run
+		bool isPinned (const size_t shard) const;
+
+	protected:
+		// This should evaluate a fitness function. Must be thread safe.
+		virtual Fitnesses evaluateFunction (const Positions& positions ) = 0;
+
+	private:
+		ShardedSwarm (const ShardedSwarm&);
+		void operator=(const ShardedSwarm&);
+
+		class Shard;
+		class ShardTopology;
+		class Worker;
+		friend class Shard;
+		friend class Worker;
+
+		// What a shard publishes for the other shards
+		struct Summary {
+			Summary ()
+			: fitness(WorstPossibleFitness()) {}
+
+			Position position;
+			Fitness fitness;
+		};
+
+		void runWorker (const size_t shard);
+		bool keepLooping ();
+		void collectSummaries ();
+
+		size_t mNumDimensions;
+		size_t mNumParticles;
+		size_t mNumIterations;
+		size_t mIterationCount;
+
+		std::vector<Shard*> mShards;
+		std::vector<gslseed_t> mShardSeeds;
+		std::vector<size_t> mCpus;
+		std::vector<char> mIsPinned;
+
+		// Double buffered by iteration parity: shards write the summaries of
+		// iteration t while reading those of iteration t - 1
+		std::vector<Summary> mSummaries[2];
+
+		Position mBestPosition;
+		Fitness mBestFitness;
+
+		size_t mEvaluationBudget;
+		double mTimeBudget;
+		double mRunStart;
+		double mRunStop;
+		const CancellationToken* mCancellationToken;
+		StopReason mStopReason;
+
+		// Run state shared with the workers, protected by the barrier
+		Barrier* mBarrier;
+		bool mIsRunning;
+		std::vector<std::string> mErrors;
+	};
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_SHARDED_H
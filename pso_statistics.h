@@ -0,0 +1,231 @@
+#ifndef INC_PSO_STATISTICS_H
+#define INC_PSO_STATISTICS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+#include "pso_types.h"
+
+namespace ParticleSwarmOptimization {
+
+	// Count, mean, variance, minimum and maximum of a stream of values in
+	// constant memory (Welford's algorithm)
+	class RunningStatistics {
+	public:
+		RunningStatistics ()
+		: mCount(0), mMean(0), mM2(0),
+		  mMin(std::numeric_limits<double>::max()), mMax(-std::numeric_limits<double>::max()) {}
+
+		void add (const double x) {
+			mCount++;
+			const double delta = x - mMean;
+			mMean += delta / mCount;
+			mM2 += delta * (x - mMean);
+
+			if (x < mMin) {
+				mMin = x;
+			}
+			if (x > mMax) {
+				mMax = x;
+			}
+		}
+
+		size_t count () const {
+			return mCount;
+		}
+
+		double mean () const {
+			return mMean;
+		}
+
+		// Sample variance
+		double variance () const {
+			return (mCount > 1 ? mM2 / (mCount - 1) : 0.0);
+		}
+
+		double standardDeviation () const {
+			return std::sqrt( variance() );
+		}
+
+		double min () const {
+			return mMin;
+		}
+
+		double max () const {
+			return mMax;
+		}
+
+	private:
+		size_t mCount;
+		double mMean;
+		double mM2;
+		double mMin;
+		double mMax;
+	};
+
+	// Streaming estimate of one quantile in constant memory, using the P^2
+	// algorithm of Jain and Chlamtac (1985). Exact for fewer than five values.
+	class QuantileEstimator {
+	public:
+		QuantileEstimator (const double p = 0.5)
+		: mP(p), mCount(0) {
+			mDesired[0] = 0;
+			mDesired[1] = 2 * p;
+			mDesired[2] = 4 * p;
+			mDesired[3] = 2 + 2 * p;
+			mDesired[4] = 4;
+
+			mIncrement[0] = 0;
+			mIncrement[1] = p / 2;
+			mIncrement[2] = p;
+			mIncrement[3] = (1 + p) / 2;
+			mIncrement[4] = 1;
+
+			for (int i = 0; i < 5; i++) {
+				mPosition[i] = i;
+				mHeight[i] = 0;
+			}
+		}
+
+		void add (const double x) {
+			if (mCount < 5) {
+				mHeight[mCount++] = x;
+				std::sort(mHeight, mHeight + mCount);
+				return;
+			}
+			mCount++;
+
+			// Find the cell of x, extending the extremes if needed
+			int k;
+			if (x < mHeight[0]) {
+				mHeight[0] = x;
+				k = 0;
+			} else if (x >= mHeight[4]) {
+				mHeight[4] = std::max(mHeight[4], x);
+				k = 3;
+			} else {
+				k = 0;
+				while (x >= mHeight[k + 1]) {
+					k++;
+				}
+			}
+
+			for (int i = k + 1; i < 5; i++) {
+				mPosition[i]++;
+			}
+			for (int i = 0; i < 5; i++) {
+				mDesired[i] += mIncrement[i];
+			}
+
+			// Adjust the heights of the middle markers
+			for (int i = 1; i < 4; i++) {
+				const double d = mDesired[i] - mPosition[i];
+				if ( (d >= 1 && mPosition[i + 1] - mPosition[i] > 1) ||
+					(d <= -1 && mPosition[i - 1] - mPosition[i] < -1) ) {
+					const int sign = (d > 0 ? 1 : -1);
+					double h = parabolic(i, sign);
+					if ( (h <= mHeight[i - 1]) || (h >= mHeight[i + 1]) ) {
+						h = linear(i, sign);
+					}
+					mHeight[i] = h;
+					mPosition[i] += sign;
+				}
+			}
+		}
+
+		size_t count () const {
+			return mCount;
+		}
+
+		double value () const {
+			if (mCount == 0) {
+				return 0.0;
+			}
+			if (mCount <= 5) {
+				// mHeight holds the sorted values
+				const size_t i = static_cast<size_t>( mP * (mCount - 1) + 0.5 );
+				return mHeight[i];
+			}
+			return mHeight[2];
+		}
+
+	private:
+		double parabolic (const int i, const int d) const {
+			const double n0 = mPosition[i - 1], n1 = mPosition[i], n2 = mPosition[i + 1];
+			return mHeight[i] + d / (n2 - n0) * (
+				(n1 - n0 + d) * (mHeight[i + 1] - mHeight[i]) / (n2 - n1) +
+				(n2 - n1 - d) * (mHeight[i] - mHeight[i - 1]) / (n1 - n0) );
+		}
+
+		double linear (const int i, const int d) const {
+			return mHeight[i] + d * (mHeight[i + d] - mHeight[i]) / (mPosition[i + d] - mPosition[i]);
+		}
+
+		double mP;
+		size_t mCount;
+		double mHeight[5];
+		double mPosition[5];
+		double mDesired[5];
+		double mIncrement[5];
+	};
+
+	// Summary of many optimization trials in constant memory: best, mean and
+	// median fitness, the fraction of trials that reached a target fitness
+	// and the mean number of evaluations they needed to reach it
+	class TrialStatistics {
+	public:
+		TrialStatistics ()
+		: mMedian(0.5), mNumSuccesses(0) {}
+
+		// reachedTarget and evaluationsToTarget come from
+		// Manager::hasReachedTarget() and Manager::evaluationsToTarget()
+		void add (const Fitness fitness, const bool reachedTarget = false, const size_t evaluationsToTarget = 0) {
+			mFitness.add(fitness);
+			mMedian.add(fitness);
+			if (reachedTarget) {
+				mNumSuccesses++;
+				mEvaluationsToTarget.add( static_cast<double>(evaluationsToTarget) );
+			}
+		}
+
+		size_t numTrials () const {
+			return mFitness.count();
+		}
+
+		Fitness bestFitness () const {
+			return mFitness.min();
+		}
+
+		Fitness meanFitness () const {
+			return mFitness.mean();
+		}
+
+		Fitness medianFitness () const {
+			return mMedian.value();
+		}
+
+		const RunningStatistics& fitness () const {
+			return mFitness;
+		}
+
+		double successRate () const {
+			return (numTrials() > 0 ? static_cast<double>(mNumSuccesses) / numTrials() : 0.0);
+		}
+
+		// Mean over the successful trials only
+		double meanEvaluationsToTarget () const {
+			return mEvaluationsToTarget.mean();
+		}
+
+	private:
+		RunningStatistics mFitness;
+		QuantileEstimator mMedian;
+		size_t mNumSuccesses;
+		RunningStatistics mEvaluationsToTarget;
+	};
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_STATISTICS_H
@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "rng.h"
+
+#include "pso_sweep.h"
+
+#include "pso_manager.h"
+
+#include "pso_topology.h"
+
+#include "pso_thread.h"
+
+namespace ParticleSwarmOptimization {
+
+	SweepConfiguration::SweepConfiguration ()
+	: inertiaStart(0.72984), inertiaEnd(0.72984), cognitive(1.496172), social(1.496172),
+	  numParticles(20), topology(RingTopologyKind) {
+	}
+
+	// An empty value list stands for the default configuration value
+	template<typename T>
+	static std::vector<T> valuesOrDefault (const std::vector<T>& values, const T& fallback) {
+		return (values.empty() ? std::vector<T>(1, fallback) : values);
+	}
+
+	std::vector<SweepConfiguration> SweepSpace::grid () const {
+		const SweepConfiguration defaults;
+		const std::vector<Weight> is = valuesOrDefault(inertiaStart, defaults.inertiaStart);
+		const std::vector<Weight> ie = valuesOrDefault(inertiaEnd, defaults.inertiaEnd);
+		const std::vector<Weight> cw = valuesOrDefault(cognitive, defaults.cognitive);
+		const std::vector<Weight> sw = valuesOrDefault(social, defaults.social);
+		const std::vector<size_t> np = valuesOrDefault(numParticles, defaults.numParticles);
+		const std::vector<TopologyKind> tk = valuesOrDefault(topology, defaults.topology);
+
+		std::vector<SweepConfiguration> configurations;
+		SweepConfiguration c;
+		for (size_t a = 0; a < is.size(); a++) {
+			c.inertiaStart = is[a];
+			for (size_t b = 0; b < ie.size(); b++) {
+				c.inertiaEnd = ie[b];
+				for (size_t d = 0; d < cw.size(); d++) {
+					c.cognitive = cw[d];
+					for (size_t e = 0; e < sw.size(); e++) {
+						c.social = sw[e];
+						for (size_t f = 0; f < np.size(); f++) {
+							c.numParticles = np[f];
+							for (size_t g = 0; g < tk.size(); g++) {
+								c.topology = tk[g];
+								configurations.push_back(c);
+							}
+						}
+					}
+				}
+			}
+		}
+		return configurations;
+	}
+
+	static Weight drawBetween (const std::vector<Weight>& values, RandomNumberGenerator& rng) {
+		const Weight low = *std::min_element(values.begin(), values.end());
+		const Weight high = *std::max_element(values.begin(), values.end());
+		return rng.uniform(low, high);
+	}
+
+	template<typename T>
+	static T pickOne (const std::vector<T>& values, RandomNumberGenerator& rng) {
+		const size_t i = static_cast<size_t>( rng.uniform(0, values.size()) );
+		return values[ std::min(i, values.size() - 1) ];
+	}
+
+	std::vector<SweepConfiguration> SweepSpace::random (const size_t count, RandomNumberGenerator& rng) const {
+		const SweepConfiguration defaults;
+		const std::vector<Weight> is = valuesOrDefault(inertiaStart, defaults.inertiaStart);
+		const std::vector<Weight> ie = valuesOrDefault(inertiaEnd, defaults.inertiaEnd);
+		const std::vector<Weight> cw = valuesOrDefault(cognitive, defaults.cognitive);
+		const std::vector<Weight> sw = valuesOrDefault(social, defaults.social);
+		const std::vector<size_t> np = valuesOrDefault(numParticles, defaults.numParticles);
+		const std::vector<TopologyKind> tk = valuesOrDefault(topology, defaults.topology);
+
+		std::vector<SweepConfiguration> configurations;
+		for (size_t i = 0; i < count; i++) {
+			SweepConfiguration c;
+			c.inertiaStart = drawBetween(is, rng);
+			c.inertiaEnd = drawBetween(ie, rng);
+			c.cognitive = drawBetween(cw, rng);
+			c.social = drawBetween(sw, rng);
+			c.numParticles = pickOne(np, rng);
+			c.topology = pickOne(tk, rng);
+			configurations.push_back(c);
+		}
+		return configurations;
+	}
+
+	// One (configuration x trial) job
+	class HyperparameterSweep::Job : public Runnable {
+	public:
+		Job (HyperparameterSweep* sweep, const size_t index, const size_t trial)
+		: mSweep(sweep), mIndex(index), mTrial(trial) {}
+
+		virtual void run () {
+			try {
+				mSweep->runTrial(mIndex, mTrial);
+			} catch (const std::exception& e) {
+				mError = e.what();
+			}
+		}
+
+		const std::string& error () const {
+			return mError;
+		}
+
+	private:
+		HyperparameterSweep* mSweep;
+		size_t mIndex;
+		size_t mTrial;
+		std::string mError;
+	};
+
+	// Orders results by mean fitness, best first
+	class SweepResultCmp {
+	public:
+		bool operator()(const SweepResult& a, const SweepResult& b) const {
+			return a.fitness.mean() < b.fitness.mean();
+		}
+	};
+
+	HyperparameterSweep::HyperparameterSweep (ManagerFactory& factory, const size_t numTrials, const size_t numThreads, const gslseed_t seed)
+	: mFactory(factory), mNumTrials(numTrials), mSeed(seed), mObserver(0) {
+		mMutex = new Mutex();
+		mPool = new ThreadPool( numThreads );
+	}
+
+	HyperparameterSweep::~HyperparameterSweep () {
+		delete mPool;
+		delete mMutex;
+	}
+
+	void HyperparameterSweep::setObserver (SweepObserver* observer) {
+		mObserver = observer;
+	}
+
+	std::vector<SweepResult> HyperparameterSweep::run (const std::vector<SweepConfiguration>& configurations, const size_t numIterations) {
+		mResults.clear();
+		mResults.resize( configurations.size() );
+		for (size_t i = 0; i < configurations.size(); i++) {
+			mResults[i].configuration = configurations[i];
+			mResults[i].numIterations = numIterations;
+		}
+
+		// Configuration-major order, so that early configurations finish
+		// early and are reported while the rest is still running
+		std::vector<Job*> jobs;
+		for (size_t i = 0; i < configurations.size(); i++) {
+			for (size_t t = 0; t < mNumTrials; t++) {
+				jobs.push_back( new Job(this, i, t) );
+			}
+		}
+
+		for (size_t j = 0; j < jobs.size(); j++) {
+			mPool->submit( jobs[j] );
+		}
+		mPool->wait();
+
+		std::string error;
+		for (size_t j = 0; j < jobs.size(); j++) {
+			if (error.empty()) {
+				error = jobs[j]->error();
+			}
+			delete jobs[j];
+		}
+		if (!error.empty()) {
+			throw std::runtime_error(error);
+		}
+
+		std::vector<SweepResult> results( mResults );
+		std::stable_sort( results.begin(), results.end(), SweepResultCmp() );
+		return results;
+	}
+
+	std::vector<SweepResult> HyperparameterSweep::runSuccessiveHalving (const std::vector<SweepConfiguration>& configurations,
+		const size_t minIterations, const size_t maxIterations, const size_t eta) {
+		if ( (eta < 2) || (minIterations == 0) || (minIterations > maxIterations) ) {
+			throw std::invalid_argument("HyperparameterSweep: invalid successive halving schedule");
+		}
+
+		std::vector<SweepConfiguration> survivors( configurations );
+		size_t iterations = minIterations;
+		for (;;) {
+			std::vector<SweepResult> results = run( survivors, iterations );
+			if ( (iterations >= maxIterations) || (results.size() <= 1) ) {
+				return results;
+			}
+
+			// Results are sorted, keep the best 1/eta
+			const size_t keep = (results.size() + eta - 1) / eta;
+			survivors.clear();
+			for (size_t i = 0; i < keep; i++) {
+				survivors.push_back( results[i].configuration );
+			}
+			iterations = std::min( iterations * eta, maxIterations );
+		}
+	}
+
+	void HyperparameterSweep::runTrial (const size_t index, const size_t trial) {
+		const SweepConfiguration& configuration = mResults[index].configuration;
+
+		Manager* manager = mFactory.create( configuration, mSeed + trial, mResults[index].numIterations );
+		if (manager == 0) {
+			throw std::runtime_error("HyperparameterSweep: factory returned no manager");
+		}
+
+		Fitness fitness;
+		size_t evaluations;
+		try {
+			switch (configuration.topology) {
+			case GlobalTopologyKind:
+				manager->setTopology( new GlobalTopology(manager) );
+				break;
+			case RingTopologyKind:
+			default:
+				manager->setTopology( new RingTopology(manager) );
+				break;
+			}
+
+			manager->estimate();
+			fitness = manager->getFitness();
+			evaluations = manager->numEvaluations();
+		} catch (...) {
+			delete manager;
+			throw;
+		}
+		delete manager;
+
+		ScopedLock lock(*mMutex);
+		SweepResult& result = mResults[index];
+		result.fitness.add( fitness );
+		result.evaluations.add( static_cast<double>(evaluations) );
+		if ( (result.fitness.count() == mNumTrials) && (mObserver != 0) ) {
+			mObserver->configurationFinished( result );
+		}
+	}
+
+}; // namespace
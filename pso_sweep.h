@@ -0,0 +1,125 @@
+#ifndef INC_PSO_SWEEP_H
+#define INC_PSO_SWEEP_H
+
+#include <vector>
+
+#include "pso_types.h"
+#include "pso_statistics.h"
+
+class RandomNumberGenerator;
+
+// Seeds for GNU GSL random number generators
+// This is defined in rng.h
+typedef unsigned long int gslseed_t;
+
+namespace ParticleSwarmOptimization {
+
+	class Manager;
+	class Mutex;
+	class ThreadPool;
+
+	enum TopologyKind {
+		RingTopologyKind,
+		GlobalTopologyKind
+	};
+
+	// One point of the hyperparameter search space
+	struct SweepConfiguration {
+		SweepConfiguration ();
+
+		Weight inertiaStart;
+		Weight inertiaEnd;
+		Weight cognitive;
+		Weight social;
+		size_t numParticles;
+		TopologyKind topology;
+	};
+
+	// The values to try for every hyperparameter. A grid uses every
+	// combination; random search draws continuous weights uniformly between
+	// the smallest and largest listed value and picks population sizes and
+	// topologies from the lists.
+	struct SweepSpace {
+		std::vector<Weight> inertiaStart;
+		std::vector<Weight> inertiaEnd;
+		std::vector<Weight> cognitive;
+		std::vector<Weight> social;
+		std::vector<size_t> numParticles;
+		std::vector<TopologyKind> topology;
+
+		std::vector<SweepConfiguration> grid () const;
+		std::vector<SweepConfiguration> random (const size_t count, RandomNumberGenerator& rng) const;
+	};
+
+	// Summary of all trials of one configuration
+	struct SweepResult {
+		SweepConfiguration configuration;
+		size_t numIterations;
+		RunningStatistics fitness;
+		RunningStatistics evaluations;
+	};
+
+	// Creates the manager (a Linear PSO subclass implementing evaluateFunction)
+	// for one trial. Called concurrently from the worker threads.
+	class ManagerFactory {
+	public:
+		virtual ~ManagerFactory() {}
+
+		virtual Manager* create (const SweepConfiguration& configuration, const gslseed_t seed, const size_t numIterations) = 0;
+	};
+
+	// Receives the summary of each configuration as soon as all its trials
+	// are done. Calls are serialized.
+	class SweepObserver {
+	public:
+		virtual ~SweepObserver() {}
+
+		virtual void configurationFinished (const SweepResult& result) = 0;
+	};
+
+	// Runs every (configuration x trial) job on a shared thread pool. Trial t
+	// of every configuration uses the same seed, so configurations are
+	// compared on common random numbers.
+	class HyperparameterSweep {
+	public:
+		HyperparameterSweep (ManagerFactory& factory, const size_t numTrials, const size_t numThreads, const gslseed_t seed);
+
+		~HyperparameterSweep ();
+
+		// The observer is not owned. Pass 0 to detach it.
+		void setObserver (SweepObserver* observer);
+
+		// Results are sorted by mean fitness, best first
+		std::vector<SweepResult> run (const std::vector<SweepConfiguration>& configurations, const size_t numIterations);
+
+		// Successive halving: runs all configurations for minIterations, keeps
+		// the best 1/eta of them, multiplies the iterations by eta and repeats
+		// until maxIterations is reached or one configuration is left.
+		// Returns the results of the last round.
+		std::vector<SweepResult> runSuccessiveHalving (const std::vector<SweepConfiguration>& configurations,
+			const size_t minIterations, const size_t maxIterations, const size_t eta = 3);
+
+	private:
+		HyperparameterSweep (const HyperparameterSweep&);
+		void operator=(const HyperparameterSweep&);
+
+		class Job;
+		friend class Job;
+
+		void runTrial (const size_t index, const size_t trial);
+
+		ManagerFactory& mFactory;
+		size_t mNumTrials;
+		gslseed_t mSeed;
+		SweepObserver* mObserver;
+
+		// State of the round in progress
+		std::vector<SweepResult> mResults;
+		Mutex* mMutex;
+
+		ThreadPool* mPool;
+	};
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_SWEEP_H
@@ -0,0 +1,351 @@
+#ifndef INC_PSO_THREAD_H
+#define INC_PSO_THREAD_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <deque>
+#include <stdexcept>
+#include <vector>
+
+namespace ParticleSwarmOptimization {
+
+	// Thin wrappers around POSIX threads so that the library stays C++98.
+
+	class Mutex {
+	public:
+		Mutex () {
+			pthread_mutex_init(&mMutex, 0);
+		}
+
+		~Mutex () {
+			pthread_mutex_destroy(&mMutex);
+		}
+
+		void lock () {
+			pthread_mutex_lock(&mMutex);
+		}
+
+		void unlock () {
+			pthread_mutex_unlock(&mMutex);
+		}
+
+	private:
+		friend class Condition;
+
+		Mutex (const Mutex&);
+		void operator=(const Mutex&);
+
+		pthread_mutex_t mMutex;
+	};
+
+	// Condition variable used together with a Mutex
+	class Condition {
+	public:
+		Condition () {
+			pthread_cond_init(&mCondition, 0);
+		}
+
+		~Condition () {
+			pthread_cond_destroy(&mCondition);
+		}
+
+		// The mutex must be locked by the caller
+		void wait (Mutex& mutex) {
+			pthread_cond_wait(&mCondition, &mutex.mMutex);
+		}
+
+		// Like wait(), but gives up after the given number of seconds.
+		// Returns false on timeout.
+		bool timedWait (Mutex& mutex, const double seconds) {
+			struct timespec deadline;
+			clock_gettime(CLOCK_REALTIME, &deadline);
+			const double whole = static_cast<double>( static_cast<long>(seconds) );
+			deadline.tv_sec += static_cast<time_t>(whole);
+			deadline.tv_nsec += static_cast<long>( (seconds - whole) * 1e9 );
+			if (deadline.tv_nsec >= 1000000000L) {
+				deadline.tv_sec += 1;
+				deadline.tv_nsec -= 1000000000L;
+			}
+			return (pthread_cond_timedwait(&mCondition, &mutex.mMutex, &deadline) == 0);
+		}
+
+		void signal () {
+			pthread_cond_signal(&mCondition);
+		}
+
+		void broadcast () {
+			pthread_cond_broadcast(&mCondition);
+		}
+
+	private:
+		Condition (const Condition&);
+		void operator=(const Condition&);
+
+		pthread_cond_t mCondition;
+	};
+
+	// Locks a mutex for the lifetime of the object
+	class ScopedLock {
+	public:
+		ScopedLock (Mutex& mutex)
+		: mMutex(mutex) {
+			mMutex.lock();
+		}
+
+		~ScopedLock () {
+			mMutex.unlock();
+		}
+
+	private:
+		ScopedLock (const ScopedLock&);
+		void operator=(const ScopedLock&);
+
+		Mutex& mMutex;
+	};
+
+	// Work to be executed on a Thread
+	class Runnable {
+	public:
+		virtual ~Runnable() {}
+		virtual void run () = 0;
+	};
+
+	// A joinable thread running a Runnable. The Runnable is not owned.
+	class Thread {
+	public:
+		Thread (Runnable* runnable)
+		: mRunnable(runnable), mIsStarted(false) {}
+
+		~Thread () {
+			join();
+		}
+
+		void start () {
+			if (pthread_create(&mThread, 0, &Thread::entry, mRunnable) != 0) {
+				throw std::runtime_error("Unable to create thread");
+			}
+			mIsStarted = true;
+		}
+
+		void join () {
+			if (mIsStarted) {
+				pthread_join(mThread, 0);
+				mIsStarted = false;
+			}
+		}
+
+	private:
+		Thread (const Thread&);
+		void operator=(const Thread&);
+
+		static void* entry (void* arg) {
+			static_cast<Runnable*>(arg)->run();
+			return 0;
+		}
+
+		Runnable* mRunnable;
+		pthread_t mThread;
+		bool mIsStarted;
+	};
+
+	// Fixed set of worker threads executing submitted tasks in order of
+	// submission. Tasks are not owned and must not throw.
+	class ThreadPool {
+	public:
+		ThreadPool (const size_t numThreads)
+		: mNumPending(0), mIsStopping(false) {
+			const size_t n = (numThreads > 0 ? numThreads : 1);
+			for (size_t i = 0; i < n; i++) {
+				mWorkers.push_back( new Worker(this) );
+				mThreads.push_back( new Thread(mWorkers.back()) );
+				mThreads.back()->start();
+			}
+		}
+
+		~ThreadPool () {
+			{
+				ScopedLock lock(mMutex);
+				mIsStopping = true;
+				mTaskAvailable.broadcast();
+			}
+			for (size_t i = 0; i < mThreads.size(); i++) {
+				delete mThreads[i];
+				delete mWorkers[i];
+			}
+		}
+
+		size_t numThreads () const {
+			return mThreads.size();
+		}
+
+		void submit (Runnable* task) {
+			ScopedLock lock(mMutex);
+			mTasks.push_back(task);
+			mNumPending++;
+			mTaskAvailable.signal();
+		}
+
+		// Blocks until every submitted task has finished
+		void wait () {
+			ScopedLock lock(mMutex);
+			while (mNumPending != 0) {
+				mAllDone.wait(mMutex);
+			}
+		}
+
+	private:
+		ThreadPool (const ThreadPool&);
+		void operator=(const ThreadPool&);
+
+		class Worker : public Runnable {
+		public:
+			Worker (ThreadPool* pool)
+			: mPool(pool) {}
+
+			virtual void run () {
+				mPool->work();
+			}
+
+		private:
+			ThreadPool* mPool;
+		};
+
+		void work () {
+			for (;;) {
+				Runnable* task;
+				{
+					ScopedLock lock(mMutex);
+					while (mTasks.empty() && !mIsStopping) {
+						mTaskAvailable.wait(mMutex);
+					}
+					if (mTasks.empty()) {
+						return;
+					}
+					task = mTasks.front();
+					mTasks.pop_front();
+				}
+
+				task->run();
+
+				ScopedLock lock(mMutex);
+				mNumPending--;
+				if (mNumPending == 0) {
+					mAllDone.broadcast();
+				}
+			}
+		}
+
+		Mutex mMutex;
+		Condition mTaskAvailable;
+		Condition mAllDone;
+		std::deque<Runnable*> mTasks;
+		size_t mNumPending;
+		bool mIsStopping;
+
+		std::vector<Worker*> mWorkers;
+		std::vector<Thread*> mThreads;
+	};
+
+	// Lets another thread ask a running optimization to stop. The request is
+	// honoured between iterations.
+	class CancellationToken {
+	public:
+		CancellationToken ()
+		: mIsCancelled(0) {}
+
+		void cancel () {
+			__sync_lock_test_and_set(&mIsCancelled, 1);
+		}
+
+		void reset () {
+			__sync_lock_release(&mIsCancelled);
+		}
+
+		bool isCancelled () const {
+			// An atomic read; adding zero leaves the flag as it is
+			return (__sync_fetch_and_add(&mIsCancelled, 0) != 0);
+		}
+
+	private:
+		CancellationToken (const CancellationToken&);
+		void operator=(const CancellationToken&);
+
+		// Mutable for the atomic read in isCancelled()
+		mutable volatile int mIsCancelled;
+	};
+
+	// Blocks each caller of wait() until count threads are waiting
+	class Barrier {
+	public:
+		Barrier (const size_t count)
+		: mCount(count), mNumWaiting(0), mGeneration(0) {}
+
+		void wait () {
+			ScopedLock lock(mMutex);
+			const size_t generation = mGeneration;
+			if (++mNumWaiting == mCount) {
+				mNumWaiting = 0;
+				mGeneration++;
+				mReleased.broadcast();
+				return;
+			}
+			while (generation == mGeneration) {
+				mReleased.wait(mMutex);
+			}
+		}
+
+	private:
+		Barrier (const Barrier&);
+		void operator=(const Barrier&);
+
+		Mutex mMutex;
+		Condition mReleased;
+		size_t mCount;
+		size_t mNumWaiting;
+		size_t mGeneration;
+	};
+
+	// Number of online processors
+	inline size_t numProcessors () {
+		const long n = sysconf(_SC_NPROCESSORS_ONLN);
+		return (n > 0 ? static_cast<size_t>(n) : 1);
+	}
+
+	// Restricts the calling thread to one processor. Returns false where
+	// affinity is not supported or the processor is not available.
+	inline bool pinCurrentThread (const size_t cpu) {
+#ifdef __linux__
+		if (cpu >= CPU_SETSIZE) {
+			return false;
+		}
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		return (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0);
+#else
+		return false;
+#endif
+	}
+
+	// Atomically stores value in slot and returns the previous value.
+	// Acts as a full memory barrier.
+	template<typename T>
+	T* atomicExchange (T* volatile* slot, T* value) {
+		// Guess empty rather than read the slot without a barrier; the
+		// compare-and-swap returns the actual value if the guess was wrong
+		T* previous = 0;
+		for (;;) {
+			T* seen = __sync_val_compare_and_swap(slot, previous, value);
+			if (seen == previous) {
+				return previous;
+			}
+			previous = seen;
+		}
+	}
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_THREAD_H
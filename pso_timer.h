@@ -0,0 +1,34 @@
+#ifndef INC_PSO_TIMER_H
+#define INC_PSO_TIMER_H
+
+#include <time.h>
+
+namespace ParticleSwarmOptimization {
+
+	// Seconds on a monotonic clock, for measuring elapsed time
+	inline double monotonicSeconds () {
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return ts.tv_sec + 1e-9 * ts.tv_nsec;
+	}
+
+	class Stopwatch {
+	public:
+		Stopwatch ()
+		: mStart(monotonicSeconds()) {}
+
+		void restart () {
+			mStart = monotonicSeconds();
+		}
+
+		double elapsedSeconds () const {
+			return monotonicSeconds() - mStart;
+		}
+
+	private:
+		double mStart;
+	};
+
+}; // namespace
+
+#endif // #ifndef INC_PSO_TIMER_H
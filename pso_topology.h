@@ -1,6 +1,8 @@
 #ifndef INC_PSO_TOPOLOGY_H
 #define INC_PSO_TOPOLOGY_H
 
+#include <algorithm>
+#include <stdexcept>
 #include <vector>
 
 #include "pso_particle.h"
@@ -14,8 +16,29 @@ namespace ParticleSwarmOptimization {
 		Topology (const Manager* const manager)
 		: mManager(manager) {}
 
+		virtual ~Topology() {}
+
+		// Returned by socialBestId() when the topology only provides positions
+		static const ParticleId NoParticleId = static_cast<ParticleId>(-1);
+
 		virtual void update () = 0;
-		virtual const Position& socialBest (const Particle& asker) = 0;
+
+		// The position the asker follows. Override this, or socialBestId()
+		// if it is always the best position of a particle.
+		virtual const Position& socialBest (const Particle& asker) {
+			const ParticleId pid = socialBestId(asker);
+			if (pid == NoParticleId) {
+				throw std::logic_error("Topology: override socialBest() or socialBestId()");
+			}
+			return mManager->particle(pid).best().position;
+		}
+
+		// The particle whose best position the asker follows. The default
+		// returns NoParticleId. Managers that keep the positions outside of
+		// the particles, such as BinaryManager and MappedManager, need it.
+		virtual ParticleId socialBestId (const Particle& /*asker*/) {
+			return NoParticleId;
+		}
 
 	protected:
 		const Manager* const manager() const {
@@ -59,15 +82,12 @@ namespace ParticleSwarmOptimization {
 			// This allows us to do the bulk computation at one time
 		}
 
-		virtual const Position& socialBest (const Particle& asker) {
+		virtual ParticleId socialBestId (const Particle& asker) {
 			// get the neighbor particle ids
 			std::vector<ParticleId> neighbors = getNeighborParticleIds( asker.id() );
 
 			// get the neighbor with the best fitness
-			const ParticleId pid = *std::min_element(neighbors.begin(), neighbors.end(), ParticleBestFitnessCmp(manager()));
-
-			// return the best neighbors best position
-			return manager()->particle(pid).best().position;
+			return *std::min_element(neighbors.begin(), neighbors.end(), ParticleBestFitnessCmp(manager()));
 		}
 
 	protected:
@@ -106,6 +126,30 @@ namespace ParticleSwarmOptimization {
 	private:
 		size_t mNumNeighbors;
 	};
+
+	// Global best (gbest) topology: every particle follows the best particle
+	class GlobalTopology : public Topology {
+	public:
+		GlobalTopology (const Manager* const manager)
+		: Topology(manager), mBest(0) {}
+
+		virtual void update () {
+			mBest = 0;
+			ParticleBestFitnessCmp cmp(manager());
+			for (ParticleId pid = 1; pid < manager()->numParticles(); pid++) {
+				if (cmp(pid, mBest)) {
+					mBest = pid;
+				}
+			}
+		}
+
+		virtual ParticleId socialBestId (const Particle& /*asker*/) {
+			return mBest;
+		}
+
+	private:
+		ParticleId mBest;
+	};
 };
 
 #endif // #ifndef INC_PSO_TOPOLOGY_H
@@ -5,7 +5,15 @@
 #include <vector>
 
 namespace ParticleSwarmOptimization {
+	// Position and velocity components. Define PSO_SINGLE_PRECISION to store
+	// them as float, which halves the memory traffic of large swarms.
+	// Fitnesses are always accumulated and compared in double precision.
+#ifdef PSO_SINGLE_PRECISION
+	typedef float VecCom;
+#else
 	typedef double VecCom;
+#endif
+
 	typedef std::vector<VecCom> Vector;
 	typedef Vector Position;
 	typedef std::vector<Position> Positions;
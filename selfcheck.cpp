@@ -0,0 +1,1088 @@
+// Self-checks of the optimizer: the threaded components (the island model,
+// the pipelined manager, the resilient evaluator and the evaluation broker),
+// noisy evaluation, restarts, stopping, initializers, statistics, the local
+// search, binary and memory-mapped swarms, the solution archive, health
+// telemetry, the C interface, the Pareto archive and lazy evaluation.
+//
+//   ./selfcheck      run every check, exit status 1 if any failed
+//
+// Every check prints one line. The checks use small problems and short
+// sleeps so the whole run takes a few seconds; run it under the thread
+// and address sanitizers after changing any of these components.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "rng.h"
+
+#include "pso_archive.h"
+#include "pso_binary.h"
+#include "pso_broker.h"
+#include "pso_c.h"
+#include "pso_health.h"
+#include "pso_initializer.h"
+#include "pso_islands.h"
+#include "pso_localsearch.h"
+#include "pso_manager.h"
+#include "pso_mapped.h"
+#include "pso_multiobjective.h"
+#include "pso_pipeline.h"
+#include "pso_resilient.h"
+#include "pso_restart.h"
+#include "pso_statistics.h"
+#include "pso_thread.h"
+#include "pso_timer.h"
+#include "pso_topology.h"
+
+using namespace ParticleSwarmOptimization;
+
+namespace {
+
+	const double OPTIMUM = 0.3;
+
+	size_t numFailures = 0;
+
+	void check (const std::string& name, const bool isPassed, const std::string& detail) {
+		std::printf("%-64s %s  %s\n", name.c_str(), (isPassed ? "ok" : "FAILED"), detail.c_str());
+		if (!isPassed) {
+			numFailures++;
+		}
+	}
+
+	std::string format (const char* text, const double a, const double b = 0, const double c = 0) {
+		char buffer[256];
+		std::snprintf(buffer, sizeof(buffer), text, a, b, c);
+		return buffer;
+	}
+
+	Fitness sphere (const Position& position) {
+		Fitness sum = 0;
+		for (size_t d = 0; d < position.size(); d++) {
+			sum += (position[d] - OPTIMUM) * (position[d] - OPTIMUM);
+		}
+		return sum;
+	}
+
+	Fitnesses sphere (const Positions& positions) {
+		Fitnesses fitnesses;
+		for (size_t i = 0; i < positions.size(); i++) {
+			fitnesses.push_back( sphere(positions[i]) );
+		}
+		return fitnesses;
+	}
+
+	class SphereManager : public Manager {
+	public:
+		SphereManager (const gslseed_t seed, const size_t numParticles, const size_t numIterations)
+		: Manager(seed, 3, numParticles, numIterations) {}
+
+	protected:
+		virtual Fitnesses evaluateFunction (const Positions& positions) {
+			return sphere(positions);
+		}
+	};
+
+	// Islands
+
+	void checkIslands () {
+		std::vector<SphereManager*> islands;
+		IslandModel model(5);
+		for (size_t i = 0; i < 4; i++) {
+			islands.push_back( new SphereManager(10 + i, 10, 100) );
+			islands.back()->setTopology( new GlobalTopology(islands.back()) );
+			model.addIsland( islands.back() );
+		}
+		model.connectRing();
+		model.estimate();
+
+		Fitness best = WorstPossibleFitness();
+		for (size_t i = 0; i < islands.size(); i++) {
+			best = std::min(best, islands[i]->getFitness());
+		}
+		check("islands: converge", model.getFitness() < 1e-4, format("fitness %g", model.getFitness()));
+		check("islands: migrate", model.numMigrations() > 0, format("migrations %g", model.numMigrations()));
+		check("islands: report the best island", model.getFitness() == best, format("model %g best island %g", model.getFitness(), best));
+
+		for (size_t i = 0; i < islands.size(); i++) {
+			delete islands[i];
+		}
+	}
+
+	// Pipeline
+
+	class EvaluationJob : public Runnable {
+	public:
+		EvaluationJob (EvaluationTicket* ticket)
+		: mTicket(ticket) {}
+
+		virtual void run () {
+			usleep(1000);
+			mTicket->complete( sphere(mTicket->positions()) );
+		}
+
+	private:
+		EvaluationTicket* mTicket;
+	};
+
+	class ThreadedPipeline : public PipelinedManager {
+	public:
+		ThreadedPipeline (const gslseed_t seed, const size_t numParticles, const size_t numIterations, const size_t numChunks, const Mode mode)
+		: PipelinedManager(seed, 3, numParticles, numIterations, numChunks, mode), mPool(3) {}
+
+		virtual ~ThreadedPipeline () {
+			drain();
+			mPool.wait();
+			for (size_t i = 0; i < mJobs.size(); i++) {
+				delete mJobs[i];
+			}
+		}
+
+	protected:
+		virtual Fitnesses evaluateFunction (const Positions& positions) {
+			return sphere(positions);
+		}
+
+		virtual void submitEvaluation (EvaluationTicket* ticket) {
+			mJobs.push_back( new EvaluationJob(ticket) );
+			mPool.submit( mJobs.back() );
+		}
+
+	private:
+		ThreadPool mPool;
+		std::vector<EvaluationJob*> mJobs;
+	};
+
+	void checkPipeline () {
+		{
+			ThreadedPipeline generational(1, 20, 100, 4, PipelinedManager::Generational);
+			generational.estimate();
+			check("pipeline: generational converges", generational.getFitness() < 1e-4, format("fitness %g", generational.getFitness()));
+		}
+		{
+			ThreadedPipeline asynchronous(1, 20, 1000, 4, PipelinedManager::Asynchronous);
+			asynchronous.setEvaluationBudget(1007);
+			asynchronous.estimate();
+			const size_t evaluations = asynchronous.numEvaluations();
+			check("pipeline: asynchronous converges", asynchronous.getFitness() < 1e-3, format("fitness %g", asynchronous.getFitness()));
+			check("pipeline: asynchronous stays within the budget", evaluations <= 1007, format("evaluations %g budget 1007", evaluations));
+		}
+		{
+			// Restarts grow the swarm, a reset shrinks it back
+			ThreadedPipeline restarted(1, 10, 60, 5, PipelinedManager::Asynchronous);
+			restarted.setRestartStrategy( new StagnationRestart(3, 1e-8, 2.0, 200) );
+			restarted.estimate();
+			const size_t grown = restarted.numParticles();
+			restarted.reset();
+			restarted.estimate();
+			check("pipeline: reset after restarts", (grown > 10) && (restarted.iteration() == 60),
+			 format("particles %g after restarts, iterations %g after reset", grown, restarted.iteration()));
+		}
+	}
+
+	// Resilient evaluator
+
+	class SleepingEvaluator : public PointEvaluator {
+	public:
+		// Sleeps seconds per evaluation, and hangSeconds for the first one
+		SleepingEvaluator (const double seconds, const double hangSeconds = 0)
+		: mSeconds(seconds), mHangSeconds(hangSeconds), mNumCalls(0) {}
+
+		virtual Fitness evaluate (const Position& position) {
+			size_t call;
+			{
+				ScopedLock lock(mMutex);
+				call = mNumCalls++;
+			}
+			usleep( static_cast<useconds_t>(1e6 * (call == 0 && mHangSeconds > 0 ? mHangSeconds : mSeconds)) );
+			return sphere(position);
+		}
+
+	private:
+		double mSeconds;
+		double mHangSeconds;
+		Mutex mMutex;
+		size_t mNumCalls;
+	};
+
+	class FailingEvaluator : public PointEvaluator {
+	public:
+		virtual Fitness evaluate (const Position& position) {
+			if (position[0] < 0) {
+				throw std::runtime_error("negative");
+			}
+			return sphere(position);
+		}
+	};
+
+	// Negative positions hang until released
+	class StuckEvaluator : public PointEvaluator {
+	public:
+		StuckEvaluator ()
+		: mIsReleased(false) {}
+
+		virtual Fitness evaluate (const Position& position) {
+			if (position[0] < 0) {
+				ScopedLock lock(mMutex);
+				while (!mIsReleased) {
+					mReleased.wait(mMutex);
+				}
+			}
+			return sphere(position);
+		}
+
+		void release () {
+			ScopedLock lock(mMutex);
+			mIsReleased = true;
+			mReleased.broadcast();
+		}
+
+	private:
+		Mutex mMutex;
+		Condition mReleased;
+		bool mIsReleased;
+	};
+
+	size_t countFailed (const Fitnesses& fitnesses) {
+		size_t count = 0;
+		for (size_t i = 0; i < fitnesses.size(); i++) {
+			if (isFailedFitness(fitnesses[i])) {
+				count++;
+			}
+		}
+		return count;
+	}
+
+	void checkResilientEvaluator () {
+		{
+			// More points than threads: waiting for a thread is not a timeout
+			SleepingEvaluator sleeping(0.02);
+			EvaluationPolicy policy;
+			policy.numThreads = 4;
+			policy.timeout = 0.1;
+			policy.maxRetries = 1;
+			ResilientEvaluator evaluator(sleeping, policy);
+			const Fitnesses fitnesses = evaluator.evaluate( Positions(40, Position(3, OPTIMUM)) );
+			const ResilienceStatistics statistics = evaluator.statistics();
+			check("resilient: queued points do not time out", (countFailed(fitnesses) == 0) && (statistics.numTimeouts == 0),
+			 format("failed %g timeouts %g attempts %g", countFailed(fitnesses), statistics.numTimeouts, statistics.numAttempts));
+		}
+		{
+			// A hanging evaluation is abandoned and retried
+			SleepingEvaluator hanging(0.01, 1.0);
+			EvaluationPolicy policy;
+			policy.numThreads = 2;
+			policy.timeout = 0.2;
+			policy.maxRetries = 1;
+			ResilientEvaluator evaluator(hanging, policy);
+			const double start = monotonicSeconds();
+			const Fitnesses fitnesses = evaluator.evaluate( Positions(6, Position(3, OPTIMUM)) );
+			const double seconds = monotonicSeconds() - start;
+			const ResilienceStatistics statistics = evaluator.statistics();
+			check("resilient: hanging evaluations time out", (countFailed(fitnesses) == 0) && (statistics.numTimeouts == 1) && (seconds < 0.9),
+			 format("failed %g timeouts %g seconds %g", countFailed(fitnesses), statistics.numTimeouts, seconds));
+		}
+		{
+			// More hanging evaluations than threads may be started
+			StuckEvaluator stuck;
+			EvaluationPolicy policy;
+			policy.numThreads = 1;
+			policy.timeout = 0.05;
+			ResilientEvaluator evaluator(stuck, policy);
+			Positions positions( 3, Position(3, -1.0) );
+			positions.push_back( Position(3, OPTIMUM) );
+			const Fitnesses fitnesses = evaluator.evaluate(positions);
+			stuck.release();
+			const Fitnesses next = evaluator.evaluate( Positions(4, Position(3, OPTIMUM)) );
+			check("resilient: gives up once every thread is stuck", (countFailed(fitnesses) == 4) && (countFailed(next) == 0),
+			 format("failed %g, then %g", countFailed(fitnesses), countFailed(next)));
+		}
+		{
+			FailingEvaluator failing;
+			EvaluationPolicy policy;
+			policy.maxRetries = 2;
+			ResilientEvaluator evaluator(failing, policy);
+			Positions positions;
+			positions.push_back( Position(3, -0.5) );
+			positions.push_back( Position(3, 0.5) );
+			const Fitnesses fitnesses = evaluator.evaluate(positions);
+			const ResilienceStatistics statistics = evaluator.statistics();
+			check("resilient: errors are retried, then reported as failed",
+			 isFailedFitness(fitnesses[0]) && !isFailedFitness(fitnesses[1]) && (statistics.numRetries == 2),
+			 format("failed %g retries %g", countFailed(fitnesses), statistics.numRetries));
+		}
+	}
+
+	// Broker
+
+	class CountingEvaluator : public BatchEvaluator {
+	public:
+		virtual Fitnesses evaluate (const Positions& positions) {
+			for (size_t i = 0; i < positions.size(); i++) {
+				if (positions[i].empty()) {
+					throw std::runtime_error("empty position");
+				}
+			}
+			usleep(2000);
+			return sphere(positions);
+		}
+	};
+
+	class BrokerClient : public Runnable {
+	public:
+		BrokerClient (EvaluationBroker* broker, const size_t index)
+		: mBroker(broker), mIndex(index), mNumWrong(0) {}
+
+		virtual void run () {
+			for (size_t r = 0; r < 20; r++) {
+				Positions positions;
+				for (size_t i = 0; i < 3; i++) {
+					positions.push_back( Position(3, 0.01 * (mIndex + r + i)) );
+				}
+				const Fitnesses fitnesses = mBroker->evaluate(positions);
+				const Fitnesses expected = sphere(positions);
+				if (fitnesses != expected) {
+					mNumWrong++;
+				}
+			}
+		}
+
+		size_t numWrong () const {
+			return mNumWrong;
+		}
+
+	private:
+		EvaluationBroker* mBroker;
+		size_t mIndex;
+		size_t mNumWrong;
+	};
+
+	void checkBroker () {
+		CountingEvaluator counting;
+		EvaluationBroker broker(counting, 24, 0.005);
+
+		std::vector<BrokerClient*> clients;
+		std::vector<Thread*> threads;
+		for (size_t i = 0; i < 8; i++) {
+			clients.push_back( new BrokerClient(&broker, i) );
+			threads.push_back( new Thread(clients.back()) );
+			threads.back()->start();
+		}
+
+		size_t numWrong = 0;
+		for (size_t i = 0; i < threads.size(); i++) {
+			threads[i]->join();
+			numWrong += clients[i]->numWrong();
+			delete threads[i];
+			delete clients[i];
+		}
+
+		const BrokerStatistics statistics = broker.statistics();
+		check("broker: results reach their requests", numWrong == 0, format("wrong %g", numWrong));
+		check("broker: every request is evaluated once", (statistics.numRequests == 160) && (statistics.numPoints == 480),
+		 format("requests %g points %g", statistics.numRequests, statistics.numPoints));
+		check("broker: requests are coalesced", statistics.batchSize.mean() > 3,
+		 format("mean batch size %g", statistics.batchSize.mean()));
+
+		bool isRethrown = false;
+		try {
+			broker.evaluate( Positions(1, Position()) );
+		} catch (const std::runtime_error&) {
+			isRethrown = true;
+		}
+		check("broker: evaluator failures are rethrown", isRethrown, "");
+	}
+
+	// Noisy evaluation
+
+	// Four designs at fixed positions, each sampled twice at mean +- 0.5
+	class NoisyDesigns : public Manager {
+	public:
+		NoisyDesigns (const Fitness* means)
+		: Manager(1, 1, 4, 10), mMeans(means), mIsSetup(false) {
+			enableNoisyEvaluation(4);
+			for (ParticleId pid = 0; pid < 4; pid++) {
+				restoreParticle( pid, Position(1, design(pid)), means[pid] - 0.5 );
+			}
+
+			// Sample every best once more; the current states evaluate worse
+			// and do not replace them
+			mIsSetup = true;
+			updateParticleFitnessesNoisy();
+			mIsSetup = false;
+		}
+
+		std::vector<size_t> allocate (const size_t count) const {
+			std::vector<size_t> allocated( numParticles(), 0 );
+			const std::vector<ParticleId> selected = selectReevaluations(count);
+			for (size_t k = 0; k < selected.size(); k++) {
+				allocated[ selected[k] ]++;
+			}
+			return allocated;
+		}
+
+	protected:
+		virtual Fitnesses evaluateFunction (const Positions& positions) {
+			Fitnesses fitnesses;
+			for (size_t i = 0; i < positions.size(); i++) {
+				const Fitness mean = mMeans[ static_cast<size_t>(positions[i][0] * 4 + 2) ];
+				fitnesses.push_back( i < numParticles() ? mean + 100 : mean + 0.5 );
+			}
+			return fitnesses;
+		}
+
+		virtual std::vector<ParticleId> selectReevaluations (const size_t count) const {
+			if (mIsSetup) {
+				std::vector<ParticleId> all;
+				for (ParticleId pid = 0; pid < numParticles(); pid++) {
+					all.push_back(pid);
+				}
+				return all;
+			}
+			return Manager::selectReevaluations(count);
+		}
+
+	private:
+		static double design (const ParticleId pid) {
+			return (static_cast<double>(pid) - 2) / 4;
+		}
+
+		const Fitness* mMeans;
+		bool mIsSetup;
+	};
+
+	void checkNoisyEvaluation () {
+		{
+			// Designs tied with the best need samples to be told apart
+			const Fitness means[4] = { 1, 1, 1, 10 };
+			const NoisyDesigns designs(means);
+			const std::vector<size_t> allocated = designs.allocate(12);
+			check("noisy: tied designs share the re-evaluations",
+			 (allocated[0] >= 3) && (allocated[1] >= 3) && (allocated[2] >= 3) && (allocated[3] == 0),
+			 format("tied designs %g, worse design %g", allocated[0] + allocated[1] + allocated[2], allocated[3]));
+		}
+		{
+			const Fitness means[4] = { 1, 1.2, 5, 10 };
+			const NoisyDesigns designs(means);
+			const std::vector<size_t> allocated = designs.allocate(12);
+			check("noisy: close designs get the re-evaluations",
+			 (allocated[0] + allocated[1] >= 10) && (allocated[3] <= allocated[2]),
+			 format("close %g, distant %g %g", allocated[0] + allocated[1], allocated[2], allocated[3]));
+		}
+	}
+
+	// Restarts
+
+	void checkRestarts () {
+		SphereManager restarted(3, 10, 100000);
+		restarted.setEvaluationBudget(3000);
+		restarted.setRestartStrategy( new StagnationRestart(5, 1e-8, 2.0, 80) );
+		restarted.estimate();
+
+		Fitness swarmBest = WorstPossibleFitness();
+		for (ParticleId pid = 0; pid < restarted.numParticles(); pid++) {
+			swarmBest = std::min(swarmBest, restarted.particle(pid).best().fitness);
+		}
+		const RunDiagnostics diagnostics = restarted.diagnostics();
+		check("restarts: grow the swarm", (restarted.numRestarts() > 0) && (restarted.numParticles() > 10),
+		 format("restarts %g particles %g", restarted.numRestarts(), restarted.numParticles()));
+		check("restarts: share the evaluation budget",
+		 (restarted.numEvaluations() <= 3000) && (diagnostics.reason == EvaluationBudgetExhausted),
+		 format("evaluations %g budget 3000", restarted.numEvaluations()));
+		check("restarts: the best so far survives", restarted.getFitness() <= swarmBest,
+		 format("best so far %g current swarm %g", restarted.getFitness(), swarmBest));
+	}
+
+	// Time budget and cancellation
+
+	class SlowSphereManager : public SphereManager {
+	public:
+		SlowSphereManager (const gslseed_t seed)
+		: SphereManager(seed, 10, 1000000) {}
+
+	protected:
+		virtual Fitnesses evaluateFunction (const Positions& positions) {
+			usleep(1000);
+			return SphereManager::evaluateFunction(positions);
+		}
+	};
+
+	class Canceller : public Runnable {
+	public:
+		Canceller (CancellationToken* token)
+		: mToken(token) {}
+
+		virtual void run () {
+			usleep(50000);
+			mToken->cancel();
+		}
+
+	private:
+		CancellationToken* mToken;
+	};
+
+	void checkStopping () {
+		{
+			SlowSphereManager timed(1);
+			timed.setTimeBudget(0.1);
+			timed.estimate();
+			const RunDiagnostics diagnostics = timed.diagnostics();
+			check("time budget: stops the run", (diagnostics.reason == TimeBudgetExhausted) && (diagnostics.elapsedSeconds < 0.5),
+			 format("seconds %g iterations %g", diagnostics.elapsedSeconds, diagnostics.iterations));
+		}
+		{
+			CancellationToken token;
+			SlowSphereManager cancelled(1);
+			cancelled.setCancellationToken(&token);
+			Canceller canceller(&token);
+			Thread thread(&canceller);
+			thread.start();
+			cancelled.estimate();
+			thread.join();
+			const RunDiagnostics diagnostics = cancelled.diagnostics();
+			check("cancellation: stops the run from another thread", (diagnostics.reason == Cancelled) && (diagnostics.elapsedSeconds < 0.5),
+			 format("seconds %g iterations %g", diagnostics.elapsedSeconds, diagnostics.iterations));
+		}
+	}
+
+	// Initializers
+
+	// Every dimension split into one stratum per point holds one point in each
+	bool isStratified (const Positions& points) {
+		const size_t n = points.size();
+		for (size_t d = 0; d < points[0].size(); d++) {
+			std::vector<size_t> counts(n, 0);
+			for (size_t i = 0; i < n; i++) {
+				const double stratum = std::floor( (points[i][d] + 1) / 2 * n );
+				if ( (stratum < 0) || (stratum >= n) || (++counts[ static_cast<size_t>(stratum) ] > 1) ) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	void checkInitializers () {
+		RandomNumberGenerator rng(7);
+		{
+			Positions points;
+			LatinHypercubeInitializer().generate(50, 5, rng, points);
+			check("initializers: Latin hypercube is stratified", (points.size() == 50) && isStratified(points), "");
+		}
+		{
+			Positions points;
+			SobolInitializer().generate(64, 5, rng, points);
+			check("initializers: Sobol is stratified", (points.size() == 64) && isStratified(points), "");
+		}
+		{
+			// Opposition costs two evaluations per particle before the first iteration
+			SphereManager tight(1, 20, 100);
+			tight.enableOppositionBasedInitialization();
+			tight.setEvaluationBudget(30);
+			tight.estimate();
+			SphereManager opposed(1, 20, 100);
+			opposed.enableOppositionBasedInitialization();
+			opposed.setEvaluationBudget(100);
+			opposed.estimate();
+			check("initializers: opposition stays within the evaluation budget",
+			 (tight.numEvaluations() == 0) && (opposed.numEvaluations() >= 40) && (opposed.numEvaluations() <= 100),
+			 format("evaluations %g with budget 30, %g with budget 100", tight.numEvaluations(), opposed.numEvaluations()));
+		}
+	}
+
+	// Statistics
+
+	void checkStatistics () {
+		QuantileEstimator median;
+		for (size_t i = 0; i < 10001; i++) {
+			median.add( static_cast<double>( (i * 7919) % 10001 ) / 10000 );
+		}
+		check("statistics: P2 median of a uniform stream", std::fabs(median.value() - 0.5) < 0.01, format("median %g", median.value()));
+
+		QuantileEstimator few;
+		few.add(3);
+		few.add(1);
+		few.add(2);
+		check("statistics: exact median of few values", few.value() == 2, format("median %g", few.value()));
+
+		TrialStatistics trials;
+		trials.add(1.0, true, 100);
+		trials.add(3.0);
+		trials.add(2.0, true, 300);
+		check("statistics: trial summary",
+		 (trials.bestFitness() == 1.0) && (trials.medianFitness() == 2.0) &&
+		 (std::fabs(trials.successRate() - 2.0 / 3) < 1e-12) && (trials.meanEvaluationsToTarget() == 200),
+		 format("median %g success rate %g evaluations to target %g", trials.medianFitness(), trials.successRate(), trials.meanEvaluationsToTarget()));
+	}
+
+	// Local search
+
+	class CountingSphere : public BatchEvaluator {
+	public:
+		CountingSphere ()
+		: mNumEvaluations(0) {}
+
+		virtual Fitnesses evaluate (const Positions& positions) {
+			mNumEvaluations += positions.size();
+			return sphere(positions);
+		}
+
+		size_t numEvaluations () const {
+			return mNumEvaluations;
+		}
+
+	private:
+		size_t mNumEvaluations;
+	};
+
+	void checkLocalSearch () {
+		{
+			PatternSearch search(0.1);
+			CountingSphere counting;
+			Position position(3, 0.9);
+			Fitness fitness = sphere(position);
+			search.refine(position, fitness, counting, 400);
+			check("local search: pattern search converges within its evaluations",
+			 (fitness < 1e-6) && (fitness == sphere(position)) && (counting.numEvaluations() <= 400),
+			 format("fitness %g evaluations %g", fitness, counting.numEvaluations()));
+		}
+		{
+			NelderMead search(0.05);
+			CountingSphere counting;
+			Position position(3, 0.9);
+			Fitness fitness = sphere(position);
+			search.refine(position, fitness, counting, 400);
+			check("local search: Nelder-Mead converges within its evaluations",
+			 (fitness < 1e-6) && (fitness == sphere(position)) && (counting.numEvaluations() <= 400),
+			 format("fitness %g evaluations %g", fitness, counting.numEvaluations()));
+		}
+		{
+			SphereManager refined(2, 10, 1000);
+			refined.setLocalSearch( new PatternSearch(), 5, 50 );
+			refined.setEvaluationBudget(1234);
+			refined.estimate();
+			check("local search: refinements stay within the evaluation budget",
+			 (refined.numEvaluations() <= 1234) && (refined.getFitness() < 1e-6),
+			 format("evaluations %g fitness %g", refined.numEvaluations(), refined.getFitness()));
+		}
+	}
+
+	// Binary
+
+	// Minimizes the number of clear bits
+	class OneMax : public BinaryManager {
+	public:
+		OneMax (const gslseed_t seed)
+		: BinaryManager(seed, 100, 20, 200) {}
+
+	protected:
+		virtual Fitnesses evaluateBits (const BitStrings& positions) {
+			Fitnesses fitnesses;
+			for (size_t i = 0; i < positions.size(); i++) {
+				fitnesses.push_back( static_cast<Fitness>( numBits() - popCount(positions[i]) ) );
+			}
+			return fitnesses;
+		}
+	};
+
+	void checkBinary () {
+		OneMax onemax(1);
+		onemax.estimate();
+		const BitString& best = onemax.getBitEstimate();
+		check("binary: improves and reports its bit estimate",
+		 (onemax.getFitness() < 20) && (onemax.getFitness() == onemax.numBits() - popCount(best)),
+		 format("fitness %g set bits %g", onemax.getFitness(), popCount(best)));
+
+		bool isPadded = true;
+		for (ParticleId pid = 0; pid < onemax.numParticles(); pid++) {
+			isPadded = isPadded && ( (onemax.bitPosition(pid).back() >> (100 % BITS_PER_WORD)) == 0 );
+		}
+		check("binary: unused bits stay clear", isPadded, "");
+
+		bool isRejected = false;
+		try {
+			onemax.immigrate( Position(3, 0.0), 0 );
+		} catch (const std::logic_error&) {
+			isRejected = true;
+		}
+		check("binary: real migrants are rejected", isRejected, "");
+	}
+
+	// Memory-mapped swarm
+
+	class MappedSphere : public MappedManager {
+	public:
+		MappedSphere (const std::string& path, const size_t numIterations)
+		: MappedManager(1, path, 3, 50, numIterations, 16) {}
+
+		// Reopens the file
+		MappedSphere (const gslseed_t seed, const std::string& path, const size_t numIterations)
+		: MappedManager(seed, path, numIterations, 16) {}
+
+	protected:
+		virtual Fitnesses evaluateFunction (const Positions& positions) {
+			return sphere(positions);
+		}
+	};
+
+	void checkMapped () {
+		char path[64];
+		std::snprintf(path, sizeof(path), "/tmp/selfcheck-%ld.swarm", static_cast<long>( getpid() ));
+
+		Fitness saved;
+		{
+			MappedSphere first(path, 20);
+			first.estimate();
+			first.sync();
+			saved = first.getFitness();
+		}
+		{
+			MappedSphere reopened(2, path, 60);
+			const size_t iteration = reopened.iteration();
+			const Fitness fitness = reopened.getFitness();
+			reopened.estimate();
+			check("mapped: reopens where the run stopped", (iteration == 20) && (fitness == saved),
+			 format("iteration %g fitness %g, saved %g", iteration, fitness, saved));
+			check("mapped: the reopened run continues",
+			 (reopened.iteration() == 60) && (reopened.getFitness() <= saved) && (sphere(reopened.getEstimate()) == reopened.getFitness()),
+			 format("iteration %g fitness %g", reopened.iteration(), reopened.getFitness()));
+		}
+		{
+			MappedSphere opposed(3, path, 80);
+			opposed.enableOppositionBasedInitialization();
+			bool isRejected = false;
+			try {
+				opposed.estimate();
+			} catch (const std::logic_error&) {
+				isRejected = true;
+			}
+			check("mapped: unsupported modes are rejected", isRejected, "");
+		}
+		unlink(path);
+	}
+
+	// Solution archive
+
+	void checkArchive () {
+		char path[64];
+		std::snprintf(path, sizeof(path), "/tmp/selfcheck-%ld.archive", static_cast<long>( getpid() ));
+
+		SolutionArchive archive(3, 10, 0.01);
+		{
+			SphereManager past(1, 20, 50);
+			past.estimate();
+			archive.addElites(past, 10);
+		}
+		archive.save(path);
+
+		SolutionArchive loaded(3, 10);
+		loaded.load(path);
+		bool isEqual = (loaded.size() == archive.size());
+		for (size_t i = 0; isEqual && (i < archive.size()); i++) {
+			isEqual = (loaded.entry(i).fitness == archive.entry(i).fitness) && (loaded.entry(i).position == archive.entry(i).position);
+		}
+		check("archive: save and load round trip", isEqual && !archive.empty(), format("entries %g, loaded %g", archive.size(), loaded.size()));
+
+		if (truncate(path, 40 + 2 * 32) == 0) {
+			bool isRejected = false;
+			try {
+				loaded.load(path);
+			} catch (const std::runtime_error&) {
+				isRejected = true;
+			}
+			check("archive: truncated files are rejected", isRejected && (loaded.size() == archive.size()), "");
+		}
+		unlink(path);
+
+		// A seeded swarm evaluates its initial positions before the first iteration
+		SphereManager tight(2, 20, 100);
+		tight.setInitializer( new ArchiveInitializer(archive) );
+		tight.setEvaluationBudget(30);
+		tight.estimate();
+		SphereManager seeded(2, 20, 100);
+		seeded.setInitializer( new ArchiveInitializer(archive) );
+		seeded.setEvaluationBudget(70);
+		seeded.estimate();
+		check("archive: seeding stays within the evaluation budget",
+		 (tight.numEvaluations() == 0) && (seeded.numEvaluations() <= 70),
+		 format("evaluations %g with budget 30, %g with budget 70", tight.numEvaluations(), seeded.numEvaluations()));
+		check("archive: elites seed the swarm", seeded.getFitness() <= archive.entry(0).fitness,
+		 format("fitness %g, archived %g", seeded.getFitness(), archive.entry(0).fitness));
+	}
+
+	// Health telemetry
+
+	class HealthReader : public Runnable {
+	public:
+		HealthReader (HealthRing* ring, const CancellationToken* done)
+		: mRing(ring), mDone(done), mNumRead(0), mIsOrdered(true), mLastIteration(0) {}
+
+		virtual void run () {
+			for (;;) {
+				const bool isDone = mDone->isCancelled();
+				SwarmHealth health;
+				while (mRing->pop(health)) {
+					mIsOrdered = mIsOrdered && (health.iteration > mLastIteration) && (health.mean.size() == 3);
+					mLastIteration = health.iteration;
+					mNumRead++;
+				}
+				if (isDone) {
+					return;
+				}
+				usleep(100);
+			}
+		}
+
+		size_t numRead () const {
+			return mNumRead;
+		}
+
+		bool isOrdered () const {
+			return mIsOrdered;
+		}
+
+	private:
+		HealthRing* mRing;
+		const CancellationToken* mDone;
+		size_t mNumRead;
+		bool mIsOrdered;
+		size_t mLastIteration;
+	};
+
+	void checkHealth () {
+		{
+			HealthRing ring(4);
+			SphereManager monitored(1, 10, 10);
+			monitored.setHealthMonitor(&ring);
+			monitored.estimate();
+
+			std::vector<SwarmHealth> records;
+			SwarmHealth health;
+			while (ring.pop(health)) {
+				records.push_back(health);
+			}
+			bool isConsistent = (records.size() == 4);
+			for (size_t i = 0; isConsistent && (i < records.size()); i++) {
+				isConsistent = (records[i].iteration == i + 1) && (records[i].numParticles == 10) && (records[i].mean.size() == 3) &&
+				 ( (i == 0) || (records[i].bestFitness <= records[i - 1].bestFitness) );
+			}
+			check("health: a full ring keeps the oldest records", isConsistent && (ring.numDropped() == 6),
+			 format("records %g dropped %g", records.size(), ring.numDropped()));
+		}
+		{
+			HealthRing ring(8);
+			CancellationToken done;
+			HealthReader reader(&ring, &done);
+			Thread thread(&reader);
+			thread.start();
+			SphereManager monitored(1, 10, 500);
+			monitored.setHealthMonitor(&ring);
+			monitored.estimate();
+			done.cancel();
+			thread.join();
+			check("health: a concurrent reader gets every record not dropped",
+			 reader.isOrdered() && (reader.numRead() + ring.numDropped() == 500),
+			 format("read %g dropped %g", reader.numRead(), ring.numDropped()));
+		}
+	}
+
+}; // namespace
+
+// Callbacks of the C interface checks, which need C linkage
+extern "C" {
+
+	static int cSphere (const double* positions, size_t numPoints, size_t numDimensions, double* fitnesses, void* userData) {
+		for (size_t i = 0; i < numPoints; i++) {
+			fitnesses[i] = sphere( Position(positions + i * numDimensions, positions + (i + 1) * numDimensions) );
+		}
+		if (userData != 0) {
+			*static_cast<size_t*>(userData) += numPoints;
+		}
+		return 0;
+	}
+
+	static int cFailing (const double*, size_t, size_t, double*, void*) {
+		return 1;
+	}
+
+}
+
+namespace {
+
+	// C interface
+
+	void checkCInterface () {
+		size_t numPoints = 0;
+		pso_swarm* swarm = pso_create(1, 3, 20, 1000, cSphere, &numPoints);
+		if (swarm == 0) {
+			check("C interface: creates a swarm", false, "");
+			return;
+		}
+		pso_set_evaluation_budget(swarm, 1000);
+		const int status = pso_run(swarm);
+		double estimate[3];
+		pso_get_estimate(swarm, estimate);
+		check("C interface: runs within the evaluation budget",
+		 (status == PSO_OK) && (pso_stop_reason(swarm) == PSO_STOP_EVALUATION_BUDGET) &&
+		 (pso_num_evaluations(swarm) == numPoints) && (numPoints <= 1000) &&
+		 (pso_get_fitness(swarm) == sphere( Position(estimate, estimate + 3) )) && (pso_get_fitness(swarm) < 1e-3),
+		 format("status %g evaluations %g fitness %g", status, numPoints, pso_get_fitness(swarm)));
+
+		const size_t iteration = pso_iteration(swarm);
+		pso_set_evaluation_budget(swarm, 0);
+		pso_cancel(swarm);
+		pso_run(swarm);
+		check("C interface: a cancel between runs stops the next one",
+		 (pso_stop_reason(swarm) == PSO_STOP_CANCELLED) && (pso_iteration(swarm) == iteration),
+		 format("stop reason %g iterations %g", pso_stop_reason(swarm), pso_iteration(swarm) - iteration));
+		pso_destroy(swarm);
+
+		swarm = pso_create(1, 3, 20, 10, cFailing, 0);
+		const int failed = pso_run(swarm);
+		check("C interface: callback failures are reported",
+		 (failed == PSO_ERROR_CALLBACK) && (std::strlen( pso_last_error(swarm) ) > 0), pso_last_error(swarm));
+		pso_destroy(swarm);
+
+		check("C interface: invalid arguments are rejected", pso_create(1, 0, 20, 10, cSphere, 0) == 0, "");
+	}
+
+	// Multi-objective
+
+	// Two spheres centered at -0.3 and 0.3; the front is the segment between them
+	class TwoSpheres : public MultiObjectiveManager {
+	public:
+		TwoSpheres ()
+		: MultiObjectiveManager(1, 3, 2, 20, 100, 30) {}
+
+	protected:
+		virtual ObjectiveVectors evaluateObjectives (const Positions& positions) {
+			ObjectiveVectors objectives;
+			for (size_t i = 0; i < positions.size(); i++) {
+				Objectives values(2, 0.0);
+				for (size_t d = 0; d < positions[i].size(); d++) {
+					values[0] += (positions[i][d] + OPTIMUM) * (positions[i][d] + OPTIMUM);
+					values[1] += (positions[i][d] - OPTIMUM) * (positions[i][d] - OPTIMUM);
+				}
+				objectives.push_back(values);
+			}
+			return objectives;
+		}
+	};
+
+	Objectives objectives (const double a, const double b) {
+		Objectives values;
+		values.push_back(a);
+		values.push_back(b);
+		return values;
+	}
+
+	bool isMutuallyNonDominated (const ParetoArchive& archive) {
+		for (size_t i = 0; i < archive.size(); i++) {
+			for (size_t j = 0; j < archive.size(); j++) {
+				if (dominates( archive.entry(i).objectives, archive.entry(j).objectives )) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	void checkParetoArchive () {
+		{
+			const Position position(1, 0.0);
+			ParetoArchive archive(2, 4);
+			const bool isKept = archive.add(position, objectives(1, 3)) && archive.add(position, objectives(3, 1)) &&
+			 archive.add(position, objectives(2, 2));
+			const bool isRejected = !archive.add(position, objectives(2.5, 2.5)) && !archive.add(position, objectives(1, 3)) &&
+			 !archive.add(position, objectives(std::numeric_limits<double>::quiet_NaN(), 0));
+			check("pareto: dominated and equal solutions are rejected", isKept && isRejected && (archive.size() == 3),
+			 format("size %g", archive.size()));
+
+			archive.add(position, objectives(1.5, 2.5));
+			archive.add(position, objectives(2.5, 1.5));
+			bool hasExtremes[2] = { false, false };
+			for (size_t i = 0; i < archive.size(); i++) {
+				hasExtremes[0] = hasExtremes[0] || (archive.entry(i).objectives == objectives(1, 3));
+				hasExtremes[1] = hasExtremes[1] || (archive.entry(i).objectives == objectives(3, 1));
+			}
+			check("pareto: pruning keeps the capacity and the extremes",
+			 (archive.size() == 4) && hasExtremes[0] && hasExtremes[1] && isMutuallyNonDominated(archive),
+			 format("size %g", archive.size()));
+
+			archive.add(position, objectives(0, 0));
+			check("pareto: a dominating solution replaces the members it dominates", archive.size() == 1,
+			 format("size %g", archive.size()));
+		}
+		{
+			TwoSpheres mopso;
+			mopso.setEvaluationBudget(1000);
+			mopso.estimate();
+			const ParetoArchive& archive = mopso.archive();
+			check("pareto: MOPSO finds a non-dominated front within its budget",
+			 (archive.size() > 10) && (archive.size() <= 30) && isMutuallyNonDominated(archive) && (mopso.numEvaluations() <= 1000),
+			 format("front %g evaluations %g", archive.size(), mopso.numEvaluations()));
+		}
+	}
+
+	// Lazy evaluation
+
+	void checkLazyEvaluation () {
+		SphereManager plain(1, 10, 50);
+		plain.estimate();
+
+		// Every particle that moved less than the tolerance keeps its fitness
+		SphereManager lazy(1, 10, 50);
+		lazy.enableLazyEvaluation(1e9);
+		lazy.estimate();
+		check("lazy: still particles are not evaluated",
+		 (lazy.numSkippedEvaluations() > 0) && (lazy.numEvaluations() + lazy.numSkippedEvaluations() == plain.numEvaluations()),
+		 format("evaluations %g skipped %g, plain run %g", lazy.numEvaluations(), lazy.numSkippedEvaluations(), plain.numEvaluations()));
+
+		SphereManager converging(1, 10, 300);
+		converging.enableLazyEvaluation(1e-6);
+		converging.estimate();
+		check("lazy: a small tolerance still converges",
+		 (converging.numSkippedEvaluations() > 0) && (converging.getFitness() < 1e-6),
+		 format("fitness %g skipped %g", converging.getFitness(), converging.numSkippedEvaluations()));
+	}
+
+}; // namespace
+
+int main () {
+	try {
+		checkIslands();
+		checkPipeline();
+		checkResilientEvaluator();
+		checkBroker();
+		checkNoisyEvaluation();
+		checkRestarts();
+		checkStopping();
+		checkInitializers();
+		checkStatistics();
+		checkLocalSearch();
+		checkBinary();
+		checkMapped();
+		checkArchive();
+		checkHealth();
+		checkCInterface();
+		checkParetoArchive();
+		checkLazyEvaluation();
+	} catch (const std::exception& e) {
+		std::printf("unexpected exception: %s\n", e.what());
+		return 1;
+	}
+
+	if (numFailures > 0) {
+		std::printf("%zu checks FAILED\n", numFailures);
+		return 1;
+	}
+	std::printf("all checks passed\n");
+	return 0;
+}